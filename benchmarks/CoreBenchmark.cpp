@@ -0,0 +1,360 @@
+// Cost of the reflection lookups and of type registration, with a small and a large registry of synthetic classes added to the type set.
+// Each operation is warmed up, then timed by batches on a thread pinned to one core: the CSV lines give nanoseconds per call at several percentiles.
+// Usage: mirror_bench_core [large registry class count] [sample count]
+
+#include "../mirror.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace mirror;
+
+namespace CoreBenchmark
+{
+	enum Weekday
+	{
+		Weekday_Monday,
+		Weekday_Tuesday,
+		Weekday_Wednesday,
+		Weekday_Thursday,
+		Weekday_Friday,
+		Weekday_Saturday,
+		Weekday_Sunday,
+	};
+
+	struct Animal
+	{
+		virtual ~Animal() {}
+
+		std::string name;
+		int32_t age = 0;
+
+		MIRROR_CLASS(Animal)
+		(
+			MIRROR_MEMBER(name)()
+			MIRROR_MEMBER(age)()
+		);
+	};
+
+	struct Dog : public Animal
+	{
+		float speed = 0.f;
+
+		MIRROR_CLASS(Dog)
+		(
+			MIRROR_PARENT(Animal)
+			MIRROR_MEMBER(speed)()
+		);
+	};
+
+	struct Puppy : public Dog
+	{
+		bool isSleeping = false;
+
+		MIRROR_CLASS(Puppy)
+		(
+			MIRROR_PARENT(Dog)
+			MIRROR_MEMBER(isSleeping)()
+		);
+	};
+
+	struct Plant
+	{
+		virtual ~Plant() {}
+
+		float height = 0.f;
+
+		MIRROR_CLASS(Plant)
+		(
+			MIRROR_MEMBER(height)()
+		);
+	};
+
+	// Type of the synthetic classes and enums, which only differ by their TypeID
+	class SyntheticTypeWrapper : public VirtualTypeWrapper
+	{
+	public:
+		SyntheticTypeWrapper(TypeID _typeID, size_t _size)
+		{
+			m_typeID = _typeID;
+			m_size = _size;
+			m_alignment = alignof(int32_t);
+		}
+	};
+
+	// Gives the wrapper, to compare reading the hot fields of the description with reading them through the wrapper as before
+	class SyntheticClass : public Class
+	{
+	public:
+		SyntheticClass(const char* _name, VirtualTypeWrapper* _virtualTypeWrapper) : Class(_name, _virtualTypeWrapper, "") {}
+
+		const VirtualTypeWrapper* getWrapper() const { return getVirtualTypeWrapper(); }
+	};
+
+	// Synthetic classes come in chains of ChainDepth classes, each adding MemberCount int members to its parent
+	static const size_t ChainDepth = 8u;
+	static const size_t MemberCount = 4u;
+	// Classes registered per timing sample
+	static const size_t RegistrationBatchSize = 8u;
+
+	class SyntheticRegistry
+	{
+	public:
+		SyntheticRegistry(size_t _classCount, size_t _enumValueCount, std::vector<double>& _outRegistrationSamples);
+		~SyntheticRegistry();
+
+		std::vector<Class*> classes;
+		std::vector<TypeID> typeIDs;
+		std::vector<std::string> names;
+		Enum* enumType = nullptr;
+
+	private:
+		// Creates the class as MIRROR_CLASS does, then adds it to the type set as ClassInitializer does
+		Class* _registerClass(size_t _index);
+	};
+}
+
+MIRROR_ENUM(CoreBenchmark::Weekday)
+(
+	MIRROR_ENUM_VALUE(CoreBenchmark::Weekday_Monday)()
+	MIRROR_ENUM_VALUE(CoreBenchmark::Weekday_Tuesday)()
+	MIRROR_ENUM_VALUE(CoreBenchmark::Weekday_Wednesday)()
+	MIRROR_ENUM_VALUE(CoreBenchmark::Weekday_Thursday)()
+	MIRROR_ENUM_VALUE(CoreBenchmark::Weekday_Friday)()
+	MIRROR_ENUM_VALUE(CoreBenchmark::Weekday_Saturday)()
+	MIRROR_ENUM_VALUE(CoreBenchmark::Weekday_Sunday)()
+);
+
+MIRROR_CLASS_DEFINITION(CoreBenchmark::Animal);
+MIRROR_CLASS_DEFINITION(CoreBenchmark::Dog);
+MIRROR_CLASS_DEFINITION(CoreBenchmark::Puppy);
+MIRROR_CLASS_DEFINITION(CoreBenchmark::Plant);
+
+using namespace CoreBenchmark;
+
+static volatile size_t s_sink = 0u;
+
+// Registers _classCount classes by batches, one registration sample per batch
+SyntheticRegistry::SyntheticRegistry(size_t _classCount, size_t _enumValueCount, std::vector<double>& _outRegistrationSamples)
+{
+	classes.reserve(_classCount);
+	for (size_t i = 0; i < _classCount; i += RegistrationBatchSize)
+	{
+		size_t end = std::min(_classCount, i + RegistrationBatchSize);
+		auto start = std::chrono::steady_clock::now();
+		for (size_t j = i; j < end; ++j)
+		{
+			classes.push_back(_registerClass(j));
+		}
+		double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		_outRegistrationSamples.push_back(nanoseconds / double(end - i));
+	}
+
+	enumType = new Enum("SyntheticEnum", new SyntheticTypeWrapper(GetTypeID<SyntheticRegistry>() + 1u, sizeof(int32_t)));
+	for (size_t i = 0; i < _enumValueCount; ++i)
+	{
+		enumType->addValue(new EnumValue(("SyntheticValue" + std::to_string(i)).c_str(), int64_t(i)));
+	}
+	GetTypeSet()->addType(enumType);
+}
+
+SyntheticRegistry::~SyntheticRegistry()
+{
+	// Enum does not own its values
+	GetTypeSet()->removeType(enumType);
+	for (EnumValue* value : enumType->getValues())
+	{
+		delete value;
+	}
+	delete enumType;
+	for (Class* clss : classes)
+	{
+		GetTypeSet()->removeType(clss);
+		delete clss;
+	}
+}
+
+Class* SyntheticRegistry::_registerClass(size_t _index)
+{
+	// Names are looked up by a 32 bits hash: a name colliding with a registered type takes a suffix
+	std::string name = "SyntheticClass" + std::to_string(_index);
+	while (GetTypeSet()->findTypeByName(name.c_str()) != nullptr)
+	{
+		name += "_";
+	}
+	TypeID typeID = GetTypeID<SyntheticRegistry>() + 2u + _index;
+	size_t depth = _index % ChainDepth;
+
+	Class* clss = new SyntheticClass(name.c_str(), new SyntheticTypeWrapper(typeID, (depth + 1u) * MemberCount * sizeof(int32_t)));
+	for (size_t i = 0; i < MemberCount; ++i)
+	{
+		std::string memberName = "member" + std::to_string(depth) + "_" + std::to_string(i);
+		clss->addMember(new ClassMember(memberName.c_str(), (depth * MemberCount + i) * sizeof(int32_t), GetTypeID<int32_t>(), ""));
+	}
+	if (depth > 0u)
+	{
+		clss->addParent(classes[_index - 1u]);
+	}
+	GetTypeSet()->addType(clss);
+
+	names.push_back(name);
+	typeIDs.push_back(typeID);
+	return clss;
+}
+
+static void PinThread()
+{
+#ifdef _WIN32
+	SetThreadAffinityMask(GetCurrentThread(), 1u);
+#elif defined(__linux__)
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	CPU_SET(sched_getcpu() >= 0 ? sched_getcpu() : 0, &cpuSet);
+	pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+#endif
+}
+
+static void PrintSamples(const char* _registry, size_t _typeCount, const char* _operation, std::vector<double>& _samples, size_t _batchSize)
+{
+	std::sort(_samples.begin(), _samples.end());
+	auto percentile = [&_samples](double _percent) { return _samples[std::min(_samples.size() - 1u, size_t(_percent / 100.0 * _samples.size()))]; };
+	printf("%s,%zu,%s,%zu,%zu,%.2f,%.2f,%.2f,%.2f,%.2f\n", _registry, _typeCount, _operation, _samples.size(), _batchSize,
+		_samples.front(), percentile(50.0), percentile(90.0), percentile(99.0), _samples.back());
+	fflush(stdout);
+}
+
+// Calls _function(i) for warmup, then times _sampleCount batches of calls. Results are added to s_sink so that calls are not optimized away.
+template <typename Operation>
+static void Measure(const char* _registry, size_t _typeCount, const char* _operation, int _sampleCount, Operation _function)
+{
+	const size_t batchSize = 256u;
+	size_t sink = 0u;
+	for (size_t i = 0; i < 64u * batchSize; ++i)
+	{
+		sink += size_t(_function(i));
+	}
+
+	std::vector<double> samples;
+	samples.reserve(_sampleCount);
+	size_t index = 0u;
+	for (int sample = 0; sample < _sampleCount; ++sample)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < batchSize; ++i, ++index)
+		{
+			sink += size_t(_function(index));
+		}
+		double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		samples.push_back(nanoseconds / double(batchSize));
+	}
+	s_sink = s_sink + sink;
+	PrintSamples(_registry, _typeCount, _operation, samples, batchSize);
+}
+
+static void RunRegistry(const char* _registry, size_t _classCount, size_t _enumValueCount, int _sampleCount)
+{
+	std::vector<double> registrationSamples;
+	SyntheticRegistry registry(_classCount, _enumValueCount, registrationSamples);
+	size_t typeCount = GetTypeSet()->getTypes().size();
+	PrintSamples(_registry, typeCount, "register_class", registrationSamples, RegistrationBatchSize);
+
+	// Lookups in a shuffled order, so that consecutive calls do not hit the same buckets
+	std::vector<size_t> order(_classCount);
+	for (size_t i = 0; i < _classCount; ++i)
+	{
+		order[i] = i;
+	}
+	std::shuffle(order.begin(), order.end(), std::mt19937(1234u));
+	std::vector<const char*> names(_classCount);
+	std::vector<TypeID> typeIDs(_classCount);
+	std::vector<const SyntheticClass*> shuffledClasses(_classCount);
+	std::vector<Class*> leaves;
+	for (size_t i = 0; i < _classCount; ++i)
+	{
+		names[i] = registry.names[order[i]].c_str();
+		typeIDs[i] = registry.typeIDs[order[i]];
+		shuffledClasses[i] = static_cast<const SyntheticClass*>(registry.classes[order[i]]);
+		if (i % ChainDepth == ChainDepth - 1u)
+		{
+			leaves.push_back(registry.classes[i]);
+		}
+	}
+	auto leaf = [&leaves](size_t _index) { return leaves[_index % leaves.size()]; };
+	std::vector<Class*> roots(leaves.size());
+	std::vector<Class*> otherRoots(leaves.size());
+	for (size_t i = 0; i < leaves.size(); ++i)
+	{
+		roots[i] = registry.classes[i * ChainDepth];
+		otherRoots[i] = registry.classes[((i + 1u) % leaves.size()) * ChainDepth];
+	}
+	std::vector<ClassMember*> members;
+
+	Measure(_registry, typeCount, "GetClass", _sampleCount, [](size_t) { return Puppy::GetClass(); });
+	Measure(_registry, typeCount, "findTypeByID", _sampleCount, [&typeIDs](size_t _i) { return GetTypeSet()->findTypeByID(typeIDs[_i % typeIDs.size()]); });
+	Measure(_registry, typeCount, "findTypeByName", _sampleCount, [&names](size_t _i) { return GetTypeSet()->findTypeByName(names[_i % names.size()]); });
+	Measure(_registry, typeCount, "findTypeByName_missing", _sampleCount, [](size_t) { return GetTypeSet()->findTypeByName("NotRegistered"); });
+	Measure(_registry, typeCount, "findMemberByName_own", _sampleCount, [&leaf](size_t _i) { return leaf(_i)->findMemberByName("member7_2"); });
+	Measure(_registry, typeCount, "findMemberByName_inherited", _sampleCount, [&leaf](size_t _i) { return leaf(_i)->findMemberByName("member0_2"); });
+	Measure(_registry, typeCount, "getMembers", _sampleCount, [&leaf, &members](size_t _i) { members.clear(); leaf(_i)->getMembers(members); return members.size(); });
+	Measure(_registry, typeCount, "isChildOf_ancestor", _sampleCount, [&leaves, &roots](size_t _i) { return leaves[_i % leaves.size()]->isChildOf(roots[_i % roots.size()]); });
+	Measure(_registry, typeCount, "isChildOf_unrelated", _sampleCount, [&leaves, &otherRoots](size_t _i) { return leaves[_i % leaves.size()]->isChildOf(otherRoots[_i % otherRoots.size()]); });
+
+	// Fields read by traversals for each value, from the description itself, then from the wrapper the description points to
+	Measure(_registry, typeCount, "hot_fields", _sampleCount, [&shuffledClasses](size_t _i)
+	{
+		const TypeDesc* type = shuffledClasses[_i % shuffledClasses.size()];
+		return type->getTypeID() + type->getSize() + type->getAlignment() + type->getType() + type->hasFactory();
+	});
+	Measure(_registry, typeCount, "hot_fields_through_wrapper", _sampleCount, [&shuffledClasses](size_t _i)
+	{
+		const SyntheticClass* type = shuffledClasses[_i % shuffledClasses.size()];
+		const VirtualTypeWrapper* wrapper = type->getWrapper();
+		return wrapper->getTypeID() + wrapper->getSize() + wrapper->getAlignment() + type->getType() + ((wrapper->getFlags() & TypeFlag_HasFactory) != 0);
+	});
+
+	Puppy puppy;
+	Animal* animal = &puppy;
+	Measure(_registry, typeCount, "Cast_up", _sampleCount, [&puppy](size_t) { return Cast<Animal*>(&puppy); });
+	Measure(_registry, typeCount, "Cast_down", _sampleCount, [animal](size_t) { return Cast<Puppy*>(animal); });
+	Measure(_registry, typeCount, "Cast_unrelated", _sampleCount, [animal](size_t) { return Cast<Plant*>(animal); });
+
+	Enum* weekday = GetEnum<Weekday>();
+	Enum* synthetic = registry.enumType;
+	size_t lastValue = _enumValueCount - 1u;
+	Measure(_registry, typeCount, "getStringFromValue_first", _sampleCount, [weekday](size_t) { const char* name = nullptr; weekday->getStringFromValue(Weekday_Monday, name); return name; });
+	Measure(_registry, typeCount, "getStringFromValue_last", _sampleCount, [weekday](size_t) { const char* name = nullptr; weekday->getStringFromValue(Weekday_Sunday, name); return name; });
+	Measure(_registry, typeCount, "getStringFromValue_synthetic_last", _sampleCount, [synthetic, lastValue](size_t) { const char* name = nullptr; synthetic->getStringFromValue(lastValue, name); return name; });
+
+	// What a MIRROR_CLASS_DEFINITION does at static initialization, without adding to the type set. Animal has no parent, which would keep the deleted class as a child.
+	Measure(_registry, typeCount, "MIRROR_CLASS_create", _sampleCount, [](size_t) { Class* clss = Animal::__MirrorCreateClass(); delete clss; return clss; });
+}
+
+int main(int _argc, char** _argv)
+{
+	size_t largeClassCount = _argc > 1 ? size_t(atoll(_argv[1])) : 200000u;
+	int sampleCount = _argc > 2 ? std::max(1, atoi(_argv[2])) : 200;
+	largeClassCount = std::max(largeClassCount, 2u * ChainDepth);
+
+	PinThread();
+
+	printf("hardware threads: %u, samples: %d\n", std::thread::hardware_concurrency(), sampleCount);
+	printf("registry,types,operation,samples,batch,min_ns,p50_ns,p90_ns,p99_ns,max_ns\n");
+	RunRegistry("small", 64u, 8u, sampleCount);
+	RunRegistry("large", largeClassCount, 1024u, sampleCount);
+
+	return 0;
+}
@@ -0,0 +1,160 @@
+// Write time of BinarySerializer for 1 to 32 threads, on a document made of large vectors of classes and sibling entries.
+// Usage: mirror_bench_parallel_write [element count] [max thread count]
+
+#include "../mirror.h"
+#include "../tools/BinarySerializer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mirror;
+
+namespace ParallelWriteBenchmark
+{
+	enum Material
+	{
+		Material_Stone,
+		Material_Wood,
+		Material_Metal,
+	};
+
+	struct Vertex
+	{
+		float x, y, z;
+
+		MIRROR_CLASS_NOVIRTUAL(Vertex)
+		(
+			MIRROR_MEMBER(x)()
+			MIRROR_MEMBER(y)()
+			MIRROR_MEMBER(z)()
+		);
+	};
+
+	struct Mesh
+	{
+		std::string name;
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		Material material = Material_Stone;
+		float lod[4] = {};
+
+		MIRROR_CLASS_NOVIRTUAL(Mesh)
+		(
+			MIRROR_MEMBER(name)()
+			MIRROR_MEMBER(vertices)()
+			MIRROR_MEMBER(indices)()
+			MIRROR_MEMBER(material)()
+			MIRROR_MEMBER(lod)()
+		);
+	};
+
+	struct Level
+	{
+		std::string name;
+		std::vector<Mesh> meshes;
+
+		MIRROR_CLASS_NOVIRTUAL(Level)
+		(
+			MIRROR_MEMBER(name)()
+			MIRROR_MEMBER(meshes)()
+		);
+	};
+}
+
+MIRROR_ENUM(ParallelWriteBenchmark::Material)
+(
+	MIRROR_ENUM_VALUE(ParallelWriteBenchmark::Material_Stone)()
+	MIRROR_ENUM_VALUE(ParallelWriteBenchmark::Material_Wood)()
+	MIRROR_ENUM_VALUE(ParallelWriteBenchmark::Material_Metal)()
+);
+
+MIRROR_CLASS_DEFINITION(ParallelWriteBenchmark::Vertex);
+MIRROR_CLASS_DEFINITION(ParallelWriteBenchmark::Mesh);
+MIRROR_CLASS_DEFINITION(ParallelWriteBenchmark::Level);
+
+using namespace ParallelWriteBenchmark;
+
+static void FillLevel(Level& _level, size_t _meshCount, size_t _seed)
+{
+	_level.name = "level" + std::to_string(_seed);
+	_level.meshes.resize(_meshCount);
+	for (size_t i = 0; i < _meshCount; ++i)
+	{
+		Mesh& mesh = _level.meshes[i];
+		mesh.name = "mesh" + std::to_string(i);
+		mesh.vertices.resize(1 + (i + _seed) % 24);
+		for (size_t j = 0; j < mesh.vertices.size(); ++j)
+		{
+			mesh.vertices[j] = { float(i), float(j), float(_seed) };
+		}
+		mesh.indices.resize(3 * mesh.vertices.size());
+		for (size_t j = 0; j < mesh.indices.size(); ++j)
+		{
+			mesh.indices[j] = uint32_t(j % mesh.vertices.size());
+		}
+		mesh.material = Material((i + _seed) % 3);
+		mesh.lod[i % 4] = float(i);
+	}
+}
+
+int main(int _argc, char** _argv)
+{
+	size_t meshCount = _argc > 1 ? size_t(atoll(_argv[1])) : 200000u;
+	size_t maxThreadCount = _argc > 2 ? size_t(atoll(_argv[2])) : 32u;
+	const size_t levelCount = 4u;
+	const int repeatCount = 5;
+
+	std::vector<Level> levels(levelCount);
+	for (size_t i = 0; i < levelCount; ++i)
+	{
+		FillLevel(levels[i], meshCount / levelCount, i);
+	}
+
+	printf("hardware threads: %u, meshes: %zu\n", std::thread::hardware_concurrency(), meshCount);
+	printf("threads,best_ms,mb_per_s,speedup,identical\n");
+
+	std::vector<uint8_t> reference;
+	double referenceMilliseconds = 0.0;
+	for (size_t threadCount = 1u; threadCount <= maxThreadCount; threadCount *= 2u)
+	{
+		BinarySerializer serializer;
+		serializer.setWriteThreadCount(threadCount);
+
+		double bestMilliseconds = 1e30;
+		const void* data = nullptr;
+		size_t dataSize = 0u;
+		for (int repeat = 0; repeat < repeatCount; ++repeat)
+		{
+			auto start = std::chrono::steady_clock::now();
+			serializer.beginWrite();
+			for (size_t i = 0; i < levelCount; ++i)
+			{
+				std::string id = "level" + std::to_string(i);
+				serializer.serialize(id.c_str(), levels[i]);
+			}
+			serializer.endWrite();
+			auto end = std::chrono::steady_clock::now();
+			bestMilliseconds = std::min(bestMilliseconds, std::chrono::duration<double, std::milli>(end - start).count());
+		}
+		serializer.getWriteData(data, dataSize);
+
+		if (threadCount == 1u)
+		{
+			reference.assign(reinterpret_cast<const uint8_t*>(data), reinterpret_cast<const uint8_t*>(data) + dataSize);
+			referenceMilliseconds = bestMilliseconds;
+		}
+		bool isIdentical = dataSize == reference.size() && memcmp(data, reference.data(), dataSize) == 0;
+
+		printf("%zu,%.3f,%.1f,%.2f,%d\n", threadCount, bestMilliseconds, dataSize / (bestMilliseconds * 1000.0), referenceMilliseconds / bestMilliseconds, isIdentical ? 1 : 0);
+		if (!isIdentical)
+			return 1;
+	}
+
+	return 0;
+}
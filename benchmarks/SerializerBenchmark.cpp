@@ -0,0 +1,433 @@
+// Write and read throughput of BinarySerializer on representative workloads, compared to copying the same bytes with memcpy.
+// Prints one CSV line per workload with the class plans of the serializer, and one without them (setUseClassPlans(false)).
+// A written document that does not read back to the same bytes, or that differs without the plans, fails the benchmark.
+// Usage: mirror_bench_serializer [scale] [repeat count]
+
+#include "../mirror.h"
+#include "../tools/BinarySerializer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mirror;
+
+namespace SerializerBenchmark
+{
+	enum Color
+	{
+		Color_Red,
+		Color_Green,
+		Color_Blue,
+		Color_Alpha,
+	};
+
+	enum Layer
+	{
+		Layer_Background = 1,
+		Layer_World = 2,
+		Layer_Interface = 4,
+	};
+
+	// Flat class of arithmetic members
+	struct Pod
+	{
+		int32_t id = 0;
+		float x = 0.f, y = 0.f, z = 0.f;
+		double weight = 0.0;
+		uint16_t flags = 0u;
+		bool isVisible = false;
+
+		MIRROR_CLASS_NOVIRTUAL(Pod)
+		(
+			MIRROR_MEMBER(id)()
+			MIRROR_MEMBER(x)()
+			MIRROR_MEMBER(y)()
+			MIRROR_MEMBER(z)()
+			MIRROR_MEMBER(weight)()
+			MIRROR_MEMBER(flags)()
+			MIRROR_MEMBER(isVisible)()
+		);
+	};
+
+	struct PodSet
+	{
+		std::vector<Pod> pods;
+
+		MIRROR_CLASS_NOVIRTUAL(PodSet)
+		(
+			MIRROR_MEMBER(pods)()
+		);
+	};
+
+	// Classes nested by value, 6 levels deep. The string keeps them from being copied as raw memory.
+	struct Nest5 { int32_t value = 0; std::string name; MIRROR_CLASS_NOVIRTUAL(Nest5)(MIRROR_MEMBER(value)() MIRROR_MEMBER(name)()); };
+	struct Nest4 { int32_t value = 0; Nest5 child; MIRROR_CLASS_NOVIRTUAL(Nest4)(MIRROR_MEMBER(value)() MIRROR_MEMBER(child)()); };
+	struct Nest3 { int32_t value = 0; Nest4 child; MIRROR_CLASS_NOVIRTUAL(Nest3)(MIRROR_MEMBER(value)() MIRROR_MEMBER(child)()); };
+	struct Nest2 { int32_t value = 0; Nest3 child; MIRROR_CLASS_NOVIRTUAL(Nest2)(MIRROR_MEMBER(value)() MIRROR_MEMBER(child)()); };
+	struct Nest1 { int32_t value = 0; Nest2 child; MIRROR_CLASS_NOVIRTUAL(Nest1)(MIRROR_MEMBER(value)() MIRROR_MEMBER(child)()); };
+	struct Nest0 { int32_t value = 0; Nest1 child; MIRROR_CLASS_NOVIRTUAL(Nest0)(MIRROR_MEMBER(value)() MIRROR_MEMBER(child)()); };
+
+	struct NestSet
+	{
+		std::vector<Nest0> roots;
+
+		MIRROR_CLASS_NOVIRTUAL(NestSet)
+		(
+			MIRROR_MEMBER(roots)()
+		);
+	};
+
+	struct FloatSet
+	{
+		std::vector<float> values;
+
+		MIRROR_CLASS_NOVIRTUAL(FloatSet)
+		(
+			MIRROR_MEMBER(values)()
+		);
+	};
+
+	struct StringSet
+	{
+		std::vector<std::string> strings;
+
+		MIRROR_CLASS_NOVIRTUAL(StringSet)
+		(
+			MIRROR_MEMBER(strings)()
+		);
+	};
+
+	struct Tagged
+	{
+		Color color = Color_Red;
+		Layer layer = Layer_Background;
+
+		MIRROR_CLASS_NOVIRTUAL(Tagged)
+		(
+			MIRROR_MEMBER(color)()
+			MIRROR_MEMBER(layer)()
+		);
+	};
+
+	struct EnumSet
+	{
+		std::vector<Tagged> items;
+
+		MIRROR_CLASS_NOVIRTUAL(EnumSet)
+		(
+			MIRROR_MEMBER(items)()
+		);
+	};
+
+	// Polymorphic graph: each shape owns a child through a raw pointer, and refers to another shape of the set
+	struct Shape
+	{
+		virtual ~Shape() { delete child; }
+
+		int32_t id = 0;
+		Shape* child = nullptr;
+		Shape* link = nullptr;
+
+		MIRROR_CLASS(Shape)
+		(
+			MIRROR_FACTORY()
+			MIRROR_MEMBER(id)()
+			MIRROR_MEMBER(child)(OwnedPointer)
+			MIRROR_MEMBER(link)()
+		);
+	};
+
+	struct Circle : public Shape
+	{
+		float radius = 0.f;
+
+		MIRROR_CLASS(Circle)
+		(
+			MIRROR_PARENT(Shape)
+			MIRROR_FACTORY()
+			MIRROR_MEMBER(radius)()
+		);
+	};
+
+	struct Box : public Shape
+	{
+		float width = 0.f, height = 0.f;
+
+		MIRROR_CLASS(Box)
+		(
+			MIRROR_PARENT(Shape)
+			MIRROR_FACTORY()
+			MIRROR_MEMBER(width)()
+			MIRROR_MEMBER(height)()
+		);
+	};
+
+	struct ShapeSet
+	{
+		std::vector<std::unique_ptr<Shape>> shapes;
+
+		MIRROR_CLASS_NOVIRTUAL(ShapeSet)
+		(
+			MIRROR_MEMBER(shapes)()
+		);
+	};
+
+	// Class of 120 members, declared and reflected from the same list
+#define WIDE_MEMBERS_10(_macro, _type, _prefix)\
+	_macro(_type, _prefix##0) _macro(_type, _prefix##1) _macro(_type, _prefix##2) _macro(_type, _prefix##3) _macro(_type, _prefix##4)\
+	_macro(_type, _prefix##5) _macro(_type, _prefix##6) _macro(_type, _prefix##7) _macro(_type, _prefix##8) _macro(_type, _prefix##9)
+#define WIDE_MEMBERS(_macro)\
+	WIDE_MEMBERS_10(_macro, int32_t, i0) WIDE_MEMBERS_10(_macro, int32_t, i1) WIDE_MEMBERS_10(_macro, int32_t, i2) WIDE_MEMBERS_10(_macro, int32_t, i3)\
+	WIDE_MEMBERS_10(_macro, float, f0) WIDE_MEMBERS_10(_macro, float, f1) WIDE_MEMBERS_10(_macro, float, f2) WIDE_MEMBERS_10(_macro, float, f3)\
+	WIDE_MEMBERS_10(_macro, double, d0) WIDE_MEMBERS_10(_macro, double, d1) WIDE_MEMBERS_10(_macro, uint8_t, b0) WIDE_MEMBERS_10(_macro, int64_t, l0)
+#define WIDE_DECLARE(_type, _name) _type _name = 0;
+#define WIDE_REFLECT(_type, _name) MIRROR_MEMBER(_name)()
+
+	struct Wide
+	{
+		WIDE_MEMBERS(WIDE_DECLARE)
+
+		MIRROR_CLASS_NOVIRTUAL(Wide)
+		(
+			WIDE_MEMBERS(WIDE_REFLECT)
+		);
+	};
+
+	struct WideSet
+	{
+		std::vector<Wide> items;
+
+		MIRROR_CLASS_NOVIRTUAL(WideSet)
+		(
+			MIRROR_MEMBER(items)()
+		);
+	};
+}
+
+MIRROR_ENUM(SerializerBenchmark::Color)
+(
+	MIRROR_ENUM_VALUE(SerializerBenchmark::Color_Red)()
+	MIRROR_ENUM_VALUE(SerializerBenchmark::Color_Green)()
+	MIRROR_ENUM_VALUE(SerializerBenchmark::Color_Blue)()
+	MIRROR_ENUM_VALUE(SerializerBenchmark::Color_Alpha)()
+);
+
+MIRROR_ENUM(SerializerBenchmark::Layer)
+(
+	MIRROR_ENUM_VALUE(SerializerBenchmark::Layer_Background)()
+	MIRROR_ENUM_VALUE(SerializerBenchmark::Layer_World)()
+	MIRROR_ENUM_VALUE(SerializerBenchmark::Layer_Interface)()
+);
+
+MIRROR_CLASS_DEFINITION(SerializerBenchmark::Pod);
+MIRROR_CLASS_DEFINITION(SerializerBenchmark::PodSet);
+MIRROR_CLASS_DEFINITION(SerializerBenchmark::Nest5);
+MIRROR_CLASS_DEFINITION(SerializerBenchmark::Nest4);
+MIRROR_CLASS_DEFINITION(SerializerBenchmark::Nest3);
+MIRROR_CLASS_DEFINITION(SerializerBenchmark::Nest2);
+MIRROR_CLASS_DEFINITION(SerializerBenchmark::Nest1);
+MIRROR_CLASS_DEFINITION(SerializerBenchmark::Nest0);
+MIRROR_CLASS_DEFINITION(SerializerBenchmark::NestSet);
+MIRROR_CLASS_DEFINITION(SerializerBenchmark::FloatSet);
+MIRROR_CLASS_DEFINITION(SerializerBenchmark::StringSet);
+MIRROR_CLASS_DEFINITION(SerializerBenchmark::Tagged);
+MIRROR_CLASS_DEFINITION(SerializerBenchmark::EnumSet);
+MIRROR_CLASS_DEFINITION(SerializerBenchmark::Shape);
+MIRROR_CLASS_DEFINITION(SerializerBenchmark::Circle);
+MIRROR_CLASS_DEFINITION(SerializerBenchmark::Box);
+MIRROR_CLASS_DEFINITION(SerializerBenchmark::ShapeSet);
+MIRROR_CLASS_DEFINITION(SerializerBenchmark::Wide);
+MIRROR_CLASS_DEFINITION(SerializerBenchmark::WideSet);
+
+using namespace SerializerBenchmark;
+
+static double ElapsedMilliseconds(std::chrono::steady_clock::time_point _start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+}
+
+// Best times out of _repeatCount writes and reads of _object, then of memcpy on the written bytes
+template <typename T>
+static bool RunPath(const char* _name, T& _object, size_t _objectCount, int _repeatCount, bool _useClassPlans, std::vector<uint8_t>& _outWritten)
+{
+	// Same entry id for all the paths, so that their output can be compared
+	const char* id = "data";
+	BinarySerializer serializer;
+	serializer.setUseClassPlans(_useClassPlans);
+	double writeMilliseconds = 1e30;
+	const void* data = nullptr;
+	size_t dataSize = 0u;
+	for (int repeat = 0; repeat < _repeatCount; ++repeat)
+	{
+		auto start = std::chrono::steady_clock::now();
+		serializer.beginWrite();
+		serializer.serialize(id, _object);
+		serializer.endWrite();
+		writeMilliseconds = std::min(writeMilliseconds, ElapsedMilliseconds(start));
+	}
+	serializer.getWriteData(data, dataSize);
+	std::vector<uint8_t> written(reinterpret_cast<const uint8_t*>(data), reinterpret_cast<const uint8_t*>(data) + dataSize);
+
+	// Read into new objects, created and destroyed out of the timing
+	double readMilliseconds = 1e30;
+	std::unique_ptr<T> readObject;
+	for (int repeat = 0; repeat < _repeatCount; ++repeat)
+	{
+		readObject.reset();
+		readObject.reset(new T());
+		auto start = std::chrono::steady_clock::now();
+		serializer.beginRead(written.data(), written.size());
+		serializer.serialize(id, *readObject);
+		serializer.endRead();
+		readMilliseconds = std::min(readMilliseconds, ElapsedMilliseconds(start));
+	}
+
+	serializer.beginWrite();
+	serializer.serialize(id, *readObject);
+	serializer.endWrite();
+	serializer.getWriteData(data, dataSize);
+	bool isIdentical = dataSize == written.size() && memcmp(data, written.data(), dataSize) == 0;
+
+	std::vector<uint8_t> copy(written.size());
+	double memcpyMilliseconds = 1e30;
+	for (int repeat = 0; repeat < _repeatCount; ++repeat)
+	{
+		auto start = std::chrono::steady_clock::now();
+		memcpy(copy.data(), written.data(), written.size());
+		memcpyMilliseconds = std::min(memcpyMilliseconds, ElapsedMilliseconds(start));
+	}
+	memcpyMilliseconds = std::max(memcpyMilliseconds, 1e-6);
+	isIdentical = isIdentical && copy == written;
+
+	double megabytes = written.size() / 1e6;
+	printf("%s,%zu,%zu,%.3f,%.1f,%.0f,%.3f,%.1f,%.0f,%.1f,%d\n", _name, _objectCount, written.size(),
+		writeMilliseconds, megabytes / (writeMilliseconds / 1000.0), _objectCount / (writeMilliseconds / 1000.0),
+		readMilliseconds, megabytes / (readMilliseconds / 1000.0), _objectCount / (readMilliseconds / 1000.0),
+		megabytes / (memcpyMilliseconds / 1000.0), isIdentical ? 1 : 0);
+	fflush(stdout);
+	_outWritten.swap(written);
+	return isIdentical;
+}
+
+// Runs _object through the class plans cached by the serializer, then through the members of each class one by one as before them
+template <typename T>
+static bool RunWorkload(const char* _name, T& _object, size_t _objectCount, int _repeatCount)
+{
+	std::vector<uint8_t> withPlans;
+	std::vector<uint8_t> withoutPlans;
+	bool isIdentical = RunPath(_name, _object, _objectCount, _repeatCount, true, withPlans);
+	isIdentical &= RunPath((std::string(_name) + "_without_plans").c_str(), _object, _objectCount, _repeatCount, false, withoutPlans);
+	return isIdentical && withPlans == withoutPlans;
+}
+
+int main(int _argc, char** _argv)
+{
+	double scale = _argc > 1 ? atof(_argv[1]) : 1.0;
+	int repeatCount = _argc > 2 ? std::max(1, atoi(_argv[2])) : 5;
+	auto count = [scale](size_t _count) { return std::max<size_t>(1u, size_t(_count * scale)); };
+
+	printf("hardware threads: %u, scale: %g, repeats: %d\n", std::thread::hardware_concurrency(), scale, repeatCount);
+	printf("workload,objects,bytes,write_ms,write_mb_per_s,write_objects_per_s,read_ms,read_mb_per_s,read_objects_per_s,memcpy_mb_per_s,identical\n");
+
+	bool isIdentical = true;
+	{
+		PodSet set;
+		set.pods.resize(count(500000u));
+		for (size_t i = 0; i < set.pods.size(); ++i)
+		{
+			Pod& pod = set.pods[i];
+			pod.id = int32_t(i);
+			pod.x = float(i);
+			pod.y = float(i) * 0.5f;
+			pod.z = -float(i);
+			pod.weight = double(i) / 3.0;
+			pod.flags = uint16_t(i);
+			pod.isVisible = i % 2 == 0;
+		}
+		isIdentical &= RunWorkload("pod", set, set.pods.size(), repeatCount);
+	}
+	{
+		NestSet set;
+		set.roots.resize(count(200000u));
+		for (size_t i = 0; i < set.roots.size(); ++i)
+		{
+			Nest0& root = set.roots[i];
+			root.value = int32_t(i);
+			root.child.child.child.value = int32_t(i * 3);
+			root.child.child.child.child.child.name = "leaf";
+		}
+		isIdentical &= RunWorkload("nested", set, set.roots.size(), repeatCount);
+	}
+	{
+		FloatSet set;
+		set.values.resize(count(8u * 1024u * 1024u));
+		for (size_t i = 0; i < set.values.size(); ++i)
+		{
+			set.values[i] = float(i) * 0.25f;
+		}
+		isIdentical &= RunWorkload("vector_float", set, set.values.size(), repeatCount);
+	}
+	{
+		StringSet set;
+		set.strings.resize(count(500000u));
+		for (size_t i = 0; i < set.strings.size(); ++i)
+		{
+			set.strings[i] = "string" + std::to_string(i) + std::string(i % 48, 'x');
+		}
+		isIdentical &= RunWorkload("strings", set, set.strings.size(), repeatCount);
+	}
+	{
+		EnumSet set;
+		set.items.resize(count(500000u));
+		for (size_t i = 0; i < set.items.size(); ++i)
+		{
+			set.items[i].color = Color(i % 4);
+			set.items[i].layer = Layer(1 << (i % 3));
+		}
+		isIdentical &= RunWorkload("enums", set, set.items.size(), repeatCount);
+	}
+	{
+		ShapeSet set;
+		set.shapes.resize(count(100000u));
+		for (size_t i = 0; i < set.shapes.size(); ++i)
+		{
+			Circle* circle = new Circle();
+			circle->id = int32_t(i);
+			circle->radius = float(i);
+			Box* box = new Box();
+			box->id = -int32_t(i);
+			box->width = float(i);
+			box->height = 2.f;
+			circle->child = box;
+			set.shapes[i].reset(circle);
+		}
+		for (size_t i = 0; i < set.shapes.size(); ++i)
+		{
+			set.shapes[i]->link = set.shapes[(i * 7u) % set.shapes.size()].get();
+			set.shapes[i]->child->link = set.shapes[i]->child;
+		}
+		isIdentical &= RunWorkload("polymorphic_graph", set, 2u * set.shapes.size(), repeatCount);
+	}
+	{
+		WideSet set;
+		set.items.resize(count(20000u));
+		for (size_t i = 0; i < set.items.size(); ++i)
+		{
+			Wide& item = set.items[i];
+			item.i00 = int32_t(i);
+			item.f29 = float(i);
+			item.d15 = double(i);
+			item.l09 = int64_t(i) << 32;
+		}
+		isIdentical &= RunWorkload("wide_class", set, set.items.size(), repeatCount);
+	}
+
+	return isIdentical ? 0 : 1;
+}
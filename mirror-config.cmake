@@ -1,10 +1,10 @@
-
 # This script is intended to be used by a parent CMakeList.txt located somewhere else
 
 # Declare the source files
 file(GLOB_RECURSE MIRROR_SOURCES
   "${CMAKE_CURRENT_LIST_DIR}/*.cpp"
 )
+list(FILTER MIRROR_SOURCES EXCLUDE REGEX "${CMAKE_CURRENT_LIST_DIR}/benchmarks/")
 
 # Declare the header files
 file(GLOB_RECURSE MIRROR_HEADERS
@@ -16,5 +16,27 @@ set(MIRROR_INCLUDE_DIRS
   "${CMAKE_CURRENT_LIST_DIR}/"
 )
 
+# Declare the libraries to link (threads used by the parallel writer of the binary serializer)
+find_package(Threads REQUIRED)
+set(MIRROR_LIBRARIES
+  Threads::Threads
+)
+
+# Optional benchmark executables
+option(MIRROR_BUILD_BENCHMARKS "Build the mirror benchmark executables" OFF)
+if (MIRROR_BUILD_BENCHMARKS)
+  add_executable(mirror_bench_parallel_write ${MIRROR_SOURCES} "${CMAKE_CURRENT_LIST_DIR}/benchmarks/ParallelWriteBenchmark.cpp")
+  target_include_directories(mirror_bench_parallel_write PRIVATE ${MIRROR_INCLUDE_DIRS})
+  target_link_libraries(mirror_bench_parallel_write PRIVATE ${MIRROR_LIBRARIES})
+
+  add_executable(mirror_bench_serializer ${MIRROR_SOURCES} "${CMAKE_CURRENT_LIST_DIR}/benchmarks/SerializerBenchmark.cpp")
+  target_include_directories(mirror_bench_serializer PRIVATE ${MIRROR_INCLUDE_DIRS})
+  target_link_libraries(mirror_bench_serializer PRIVATE ${MIRROR_LIBRARIES})
+
+  add_executable(mirror_bench_core ${MIRROR_SOURCES} "${CMAKE_CURRENT_LIST_DIR}/benchmarks/CoreBenchmark.cpp")
+  target_include_directories(mirror_bench_core PRIVATE ${MIRROR_INCLUDE_DIRS})
+  target_link_libraries(mirror_bench_core PRIVATE ${MIRROR_LIBRARIES})
+endif()
+
 # Message the user will see configuring his cmake project.
-message("Mirror (mirror-config.cmake) script read, use MIRROR_SOURCES, MIRROR_HEADERS and MIRROR_INCLUDE_DIRS."  )
+message("Mirror (mirror-config.cmake) script read, use MIRROR_SOURCES, MIRROR_HEADERS, MIRROR_INCLUDE_DIRS and MIRROR_LIBRARIES."  )
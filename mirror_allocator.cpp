@@ -0,0 +1,167 @@
+#include "mirror.h"
+#include "mirror_allocator.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace mirror
+{
+	static size_t AlignUp(size_t _value, size_t _alignment)
+	{
+		return (_value + _alignment - 1u) & ~(_alignment - 1u);
+	}
+
+	static void* AlignedMalloc(size_t _size, size_t _alignment)
+	{
+		_alignment = std::max(_alignment, sizeof(void*));
+		assert((_alignment & (_alignment - 1u)) == 0u);
+#ifdef _WIN32
+		return _aligned_malloc(_size, _alignment);
+#else
+		void* pointer = nullptr;
+		if (posix_memalign(&pointer, _alignment, _size) != 0)
+			return nullptr;
+		return pointer;
+#endif
+	}
+
+	static void AlignedFree(void* _pointer)
+	{
+#ifdef _WIN32
+		_aligned_free(_pointer);
+#else
+		free(_pointer);
+#endif
+	}
+
+	void* DefaultAllocator::allocate(size_t _size, size_t _alignment)
+	{
+		return AlignedMalloc(_size, _alignment);
+	}
+
+	void DefaultAllocator::deallocate(void* _pointer, size_t _size)
+	{
+		AlignedFree(_pointer);
+	}
+
+	DefaultAllocator* GetDefaultAllocator()
+	{
+		static DefaultAllocator s_defaultAllocator;
+		return &s_defaultAllocator;
+	}
+
+	PoolAllocator::PoolAllocator(size_t _blockSize, size_t _blockAlignment, size_t _blocksPerPage)
+		: m_blockAlignment(std::max(_blockAlignment, alignof(FreeBlock)))
+		, m_blocksPerPage(_blocksPerPage)
+	{
+		assert(_blockSize > 0u);
+		assert(_blocksPerPage > 0u);
+		m_blockSize = AlignUp(std::max(_blockSize, sizeof(FreeBlock)), m_blockAlignment);
+	}
+
+	PoolAllocator::~PoolAllocator()
+	{
+		for (void* page : m_pages)
+		{
+			AlignedFree(page);
+		}
+	}
+
+	void* PoolAllocator::allocate(size_t _size, size_t _alignment)
+	{
+		assert(_size <= m_blockSize);
+		assert(_alignment <= m_blockAlignment);
+
+		if (m_freeList)
+		{
+			FreeBlock* block = m_freeList;
+			m_freeList = block->next;
+			return block;
+		}
+
+		if (m_pageCursor == m_pageEnd)
+		{
+			size_t pageSize = m_blockSize * m_blocksPerPage;
+			uint8_t* page = reinterpret_cast<uint8_t*>(AlignedMalloc(pageSize, m_blockAlignment));
+			if (!page)
+				return nullptr;
+
+			m_pages.push_back(page);
+			m_pageCursor = page;
+			m_pageEnd = page + pageSize;
+		}
+
+		void* block = m_pageCursor;
+		m_pageCursor += m_blockSize;
+		return block;
+	}
+
+	void PoolAllocator::deallocate(void* _pointer, size_t _size)
+	{
+		if (!_pointer)
+			return;
+
+		FreeBlock* block = reinterpret_cast<FreeBlock*>(_pointer);
+		block->next = m_freeList;
+		m_freeList = block;
+	}
+
+	ArenaAllocator::ArenaAllocator(size_t _pageSize)
+		: m_pageSize(_pageSize)
+	{
+		assert(_pageSize > 0u);
+	}
+
+	ArenaAllocator::~ArenaAllocator()
+	{
+		for (Page& page : m_pages)
+		{
+			AlignedFree(page.data);
+		}
+	}
+
+	void* ArenaAllocator::allocate(size_t _size, size_t _alignment)
+	{
+		_alignment = std::max<size_t>(_alignment, 1u);
+
+		uint8_t* pointer = reinterpret_cast<uint8_t*>(AlignUp(reinterpret_cast<size_t>(m_cursor), _alignment));
+		if (!m_cursor || pointer + _size > m_end)
+		{
+			// Allocations bigger than a page get a page of their own
+			size_t pageSize = std::max(m_pageSize, _size);
+			Page page;
+			page.data = reinterpret_cast<uint8_t*>(AlignedMalloc(pageSize, std::max<size_t>(_alignment, 16u)));
+			page.size = pageSize;
+			if (!page.data)
+				return nullptr;
+
+			m_pages.push_back(page);
+			pointer = page.data;
+			m_end = page.data + pageSize;
+		}
+
+		m_cursor = pointer + _size;
+		m_allocatedSize += _size;
+		return pointer;
+	}
+
+	void ArenaAllocator::reset()
+	{
+		for (size_t i = 1; i < m_pages.size(); ++i)
+		{
+			AlignedFree(m_pages[i].data);
+		}
+		if (!m_pages.empty())
+		{
+			m_pages.resize(1);
+			m_cursor = m_pages[0].data;
+			m_end = m_pages[0].data + m_pages[0].size;
+		}
+		m_allocatedSize = 0u;
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mirror
+{
+	// Interface used by TypeDesc to allocate the memory of the instances it creates.
+	// None of the allocators below are thread safe.
+	class MIRROR_API Allocator
+	{
+	public:
+		virtual ~Allocator() {}
+
+		virtual void* allocate(size_t _size, size_t _alignment) = 0;
+		virtual void deallocate(void* _pointer, size_t _size) = 0;
+	};
+
+	// Aligned heap allocation
+	class MIRROR_API DefaultAllocator : public Allocator
+	{
+	public:
+		virtual void* allocate(size_t _size, size_t _alignment) override;
+		virtual void deallocate(void* _pointer, size_t _size) override;
+	};
+
+	MIRROR_API DefaultAllocator* GetDefaultAllocator();
+
+	// Fixed-size blocks taken from pages of _blocksPerPage blocks and recycled through a free list, intended to be set as the allocator of a class.
+	class MIRROR_API PoolAllocator : public Allocator
+	{
+	public:
+		PoolAllocator(size_t _blockSize, size_t _blockAlignment, size_t _blocksPerPage = 256u);
+		virtual ~PoolAllocator();
+
+		virtual void* allocate(size_t _size, size_t _alignment) override;
+		virtual void deallocate(void* _pointer, size_t _size) override;
+
+		size_t getBlockSize() const { return m_blockSize; }
+
+	private:
+		struct FreeBlock { FreeBlock* next; };
+
+		size_t m_blockSize;
+		size_t m_blockAlignment;
+		size_t m_blocksPerPage;
+
+		FreeBlock* m_freeList = nullptr;
+		uint8_t* m_pageCursor = nullptr;
+		uint8_t* m_pageEnd = nullptr;
+		std::vector<void*> m_pages;
+	};
+
+	// Bump allocator: deallocate does nothing, all the memory is given back at once by reset or on destruction.
+	// Intended for load sessions whose objects all die together. Destructors of the objects are not called by reset.
+	class MIRROR_API ArenaAllocator : public Allocator
+	{
+	public:
+		ArenaAllocator(size_t _pageSize = 64u * 1024u);
+		virtual ~ArenaAllocator();
+
+		virtual void* allocate(size_t _size, size_t _alignment) override;
+		virtual void deallocate(void* _pointer, size_t _size) override {}
+
+		// Keeps the first page for the next session
+		void reset();
+
+		size_t getAllocatedSize() const { return m_allocatedSize; }
+
+	private:
+		struct Page
+		{
+			uint8_t* data;
+			size_t size;
+		};
+
+		size_t m_pageSize;
+		size_t m_allocatedSize = 0u;
+
+		uint8_t* m_cursor = nullptr;
+		uint8_t* m_end = nullptr;
+		std::vector<Page> m_pages;
+	};
+}
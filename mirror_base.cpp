@@ -67,7 +67,7 @@ namespace mirror
 		}
 
 		size_t len = lastChar - firstChar;
-		strncpy(_buf, firstChar, len);
+		memmove(_buf, firstChar, len);
 		_buf[len] = 0;
 	}
 
@@ -90,12 +90,29 @@ namespace mirror
         ALLOCATE_AND_COPY_STRING(m_data, _data);
 	}
 
+	MetaData::MetaData(const MetaData& _other)
+		: MetaData(_other.m_name, _other.m_data)
+	{
+	}
+
 	MetaData::~MetaData()
     {
         free(m_name);
         free(m_data);
     }
 
+	MetaData& MetaData::operator=(const MetaData& _other)
+	{
+		if (this != &_other)
+		{
+			free(m_name);
+			free(m_data);
+			ALLOCATE_AND_COPY_STRING(m_name, _other.m_name);
+			ALLOCATE_AND_COPY_STRING(m_data, _other.m_data);
+		}
+		return *this;
+	}
+
 	const char* MetaData::getName() const
 	{
 		return m_name;
@@ -196,10 +213,12 @@ namespace mirror
 	}
 
 	TypeDesc::TypeDesc(Type _type, const char* _name, VirtualTypeWrapper* _virtualTypeWrapper)
-		: m_type(_type)
+		: m_type(static_cast<uint8_t>(_type))
 		, m_virtualTypeWrapper(_virtualTypeWrapper)
 	{
+		static_assert(Type_COUNT <= UINT8_MAX, "Type does not fit in the TypeDesc header");
 		ALLOCATE_AND_COPY_STRING(m_name, _name);
+		copyVirtualTypeWrapperFields();
 	}
 
 	TypeDesc::~TypeDesc()
@@ -208,14 +227,128 @@ namespace mirror
 		free(m_name);
 	}
 
-	bool TypeDesc::hasFactory() const
+	void* TypeDesc::instantiate(Allocator* _allocator) const
+	{
+		if (!hasFactory())
+			return nullptr;
+
+		void* instance = nullptr;
+		if (_allocator)
+		{
+			instance = _allocator->allocate(getSize(), getAlignment());
+			if (!instance)
+				return nullptr;
+			m_virtualTypeWrapper->construct(instance, 1u);
+		}
+		else
+		{
+			instance = m_virtualTypeWrapper->instantiate();
+		}
+
+		m_allocationCounters.allocationCount.fetch_add(1u, std::memory_order_relaxed);
+		m_allocationCounters.instanceCount.fetch_add(1u, std::memory_order_relaxed);
+		m_allocationCounters.allocatedBytes.fetch_add(getSize(), std::memory_order_relaxed);
+		return instance;
+	}
+
+	void* TypeDesc::instantiateN(size_t _count, Allocator* _allocator) const
+	{
+		if (!hasFactory() || _count == 0u)
+			return nullptr;
+
+		Allocator* allocator = _allocator ? _allocator : GetDefaultAllocator();
+		size_t size = getSize() * _count;
+		void* memory = allocator->allocate(size, getAlignment());
+		if (!memory)
+			return nullptr;
+
+		m_virtualTypeWrapper->construct(memory, _count);
+
+		m_allocationCounters.allocationCount.fetch_add(1u, std::memory_order_relaxed);
+		m_allocationCounters.instanceCount.fetch_add(_count, std::memory_order_relaxed);
+		m_allocationCounters.allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+		return memory;
+	}
+
+	void* TypeDesc::instantiateAt(void* _memory, size_t _count) const
+	{
+		assert(_memory);
+		assert(reinterpret_cast<size_t>(_memory) % std::max<size_t>(getAlignment(), 1u) == 0u);
+
+		if (!hasFactory())
+			return nullptr;
+
+		m_virtualTypeWrapper->construct(_memory, _count);
+		m_allocationCounters.instanceCount.fetch_add(_count, std::memory_order_relaxed);
+		return _memory;
+	}
+
+	void TypeDesc::destroy(void* _instance, Allocator* _allocator) const
+	{
+		if (!_instance)
+			return;
+
+		if (_allocator)
+		{
+			m_virtualTypeWrapper->destroy(_instance, 1u);
+			_allocator->deallocate(_instance, getSize());
+		}
+		else
+		{
+			m_virtualTypeWrapper->deleteInstance(_instance);
+		}
+		m_allocationCounters.destroyedInstanceCount.fetch_add(1u, std::memory_order_relaxed);
+	}
+
+	void TypeDesc::destroyN(void* _instances, size_t _count, Allocator* _allocator) const
 	{
-		return m_virtualTypeWrapper->hasFactory();
+		if (!_instances)
+			return;
+
+		Allocator* allocator = _allocator ? _allocator : GetDefaultAllocator();
+		m_virtualTypeWrapper->destroy(_instances, _count);
+		allocator->deallocate(_instances, getSize() * _count);
+		m_allocationCounters.destroyedInstanceCount.fetch_add(_count, std::memory_order_relaxed);
 	}
 
-	void* TypeDesc::instantiate() const
+	void TypeDesc::destroyAt(void* _instances, size_t _count) const
 	{
-		return m_virtualTypeWrapper->instantiate();
+		assert(_instances);
+
+		m_virtualTypeWrapper->destroy(_instances, _count);
+		m_allocationCounters.destroyedInstanceCount.fetch_add(_count, std::memory_order_relaxed);
+	}
+
+	TypeDesc::AllocationStats TypeDesc::getAllocationStats() const
+	{
+		AllocationStats stats;
+		stats.allocationCount = m_allocationCounters.allocationCount.load(std::memory_order_relaxed);
+		stats.instanceCount = m_allocationCounters.instanceCount.load(std::memory_order_relaxed);
+		stats.liveInstanceCount = stats.instanceCount - m_allocationCounters.destroyedInstanceCount.load(std::memory_order_relaxed);
+		stats.allocatedBytes = m_allocationCounters.allocatedBytes.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void TypeDesc::setVirtualTypeWrapper(VirtualTypeWrapper* _virtualTypeWrapper)
+	{
+		assert(_virtualTypeWrapper);
+		assert(!m_virtualTypeWrapper || m_virtualTypeWrapper->getTypeID() == _virtualTypeWrapper->getTypeID());
+
+		if (m_virtualTypeWrapper) delete m_virtualTypeWrapper;
+		m_virtualTypeWrapper = _virtualTypeWrapper;
+		copyVirtualTypeWrapperFields();
+	}
+
+	void TypeDesc::copyVirtualTypeWrapperFields()
+	{
+		assert(m_virtualTypeWrapper);
+		assert(m_virtualTypeWrapper->getSize() <= UINT32_MAX);
+		assert(m_virtualTypeWrapper->getAlignment() <= UINT16_MAX);
+
+		m_typeID = m_virtualTypeWrapper->getTypeID();
+		m_size = static_cast<uint32_t>(m_virtualTypeWrapper->getSize());
+		m_alignment = static_cast<uint16_t>(m_virtualTypeWrapper->getAlignment());
+		m_flags = m_virtualTypeWrapper->getFlags();
 	}
 
 	void TypeDesc::setName(const char* _name)
@@ -409,18 +542,18 @@ namespace mirror
 		return m_types;
 	}
 
-	PointerTypeDesc::PointerTypeDesc(TypeID _subType, VirtualTypeWrapper* _virtualTypeWrapper)
+	PointerTypeDesc::PointerTypeDesc(TypeID _subType, const char* _subTypeName, VirtualTypeWrapper* _virtualTypeWrapper)
 		: TypeDesc(Type_Pointer, "", _virtualTypeWrapper)
 		, m_subType(_subType)
 	{
-		setName((std::string("pointer_") + GetTypeSet()->findTypeByID(_subType)->getName()).c_str());
+		setName((std::string("pointer_") + _subTypeName).c_str());
 	}
 
 	TypeDesc* PointerTypeDesc::getSubType() const { return GetTypeSet()->findTypeByID(m_subType); }
 
 
-	FixedSizeArrayTypeDesc::FixedSizeArrayTypeDesc(TypeID _subType, size_t _elementCount, VirtualTypeWrapper* _virtualTypeWrapper)
-		: TypeDesc(Type_FixedSizeArray, "fixed_size_array", _virtualTypeWrapper)
+	FixedSizeArrayTypeDesc::FixedSizeArrayTypeDesc(const char* _name, TypeID _subType, size_t _elementCount, VirtualTypeWrapper* _virtualTypeWrapper)
+		: TypeDesc(Type_FixedSizeArray, _name, _virtualTypeWrapper)
 		, m_subType(_subType)
 		, m_elementCount(_elementCount)
 	{
@@ -1,14 +1,18 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <new>
 #include <unordered_map>
 #include <vector>
 #include <set>
+#include <string>
 #include <type_traits>
 #include <typeinfo>
 #include <assert.h>
 
 #include "mirror_types.h"
+#include "mirror_allocator.h"
 
 namespace mirror
 {
@@ -24,8 +28,11 @@ namespace mirror
 	struct MIRROR_API MetaData
 	{
 		MetaData(const char* _name, const char* _data);
+		MetaData(const MetaData& _other);
 		~MetaData();
 
+		MetaData& operator=(const MetaData& _other);
+
 		const char* getName() const;
 
 		bool asBool() const;
@@ -59,15 +66,21 @@ namespace mirror
 	public:
 		TypeID getTypeID() const { return m_typeID; }
 		size_t getSize() const { return m_size; }
+		size_t getAlignment() const { return m_alignment; }
+		uint8_t getFlags() const { return m_flags; }
 
-		virtual bool hasFactory() const { return false; }
 		virtual void* instantiate() const { return nullptr; }
+		virtual void construct(void* _memory, size_t _count) const {}
+		virtual void destroy(void* _object, size_t _count) const {}
+		virtual void deleteInstance(void* _object) const {}
 
 		virtual Class* unsafeVirtualGetClass(void* _object) const { return nullptr; }
 
 	protected:
 		TypeID m_typeID = UNDEFINED_TYPEID;
 		size_t m_size = 0;
+		size_t m_alignment = 0;
+		uint8_t m_flags = TypeFlag_None;
 	};
 
 	template <typename T, typename IsShallow = void>
@@ -78,6 +91,9 @@ namespace mirror
 		{
 			m_typeID = GetTypeID<T>();
 			m_size = sizeof(T);
+			m_alignment = alignof(T);
+			m_flags = (std::is_trivially_copyable<T>::value ? TypeFlag_TriviallyCopyable : 0)
+				| (std::is_polymorphic<T>::value ? TypeFlag_Polymorphic : 0);
 		}
 	};
 
@@ -112,8 +128,26 @@ namespace mirror
 	class TVirtualTypeWrapperFactory<T, true> : public TVirtualTypeWrapperBase<T>
 	{
 	public:
-		virtual bool hasFactory() const override { return true; }
+		TVirtualTypeWrapperFactory() { this->m_flags |= TypeFlag_HasFactory; }
+
 		virtual void* instantiate() const override { return new T(); }
+		virtual void construct(void* _memory, size_t _count) const override
+		{
+			T* objects = reinterpret_cast<T*>(_memory);
+			for (size_t i = 0; i < _count; ++i)
+			{
+				new (objects + i) T();
+			}
+		}
+		virtual void destroy(void* _object, size_t _count) const override
+		{
+			T* objects = reinterpret_cast<T*>(_object);
+			for (size_t i = 0; i < _count; ++i)
+			{
+				objects[i].~T();
+			}
+		}
+		virtual void deleteInstance(void* _object) const override { delete reinterpret_cast<T*>(_object); }
 	};
 
 	template <typename T, bool Factory = false, bool IsClass = false>
@@ -127,37 +161,84 @@ namespace mirror
 		virtual Class* unsafeVirtualGetClass(void* _object) const { return reinterpret_cast<T*>(_object)->getClass(); }
 	};
 
-	class MIRROR_API TypeDesc
+	// The fields read by traversals (kind, size, alignment, TypeID and flags) are copied from the virtual type wrapper into the first cache line of
+	// the type description, the wrapper itself is only used to construct and destroy instances.
+	class MIRROR_API alignas(64) TypeDesc
 	{
 	public:
 		TypeDesc(Type _type, VirtualTypeWrapper* _virtualTypeWrapper);
 		TypeDesc(Type _type, const char* _name, VirtualTypeWrapper* _virtualTypeWrapper);
-		// NOTE(Remi|2020/04/26): virtual specifier is not needed, but is added to allow the debugger to show inherited types
+		// NOTE: the TypeSet deletes derived type descriptions through this class, hence the virtual destructor
 		virtual ~TypeDesc();
 
-		Type getType() const { return m_type; }
+		Type getType() const { return static_cast<Type>(m_type); }
 		const char* getName() const { return m_name; }
-		TypeID getTypeID() const { return m_virtualTypeWrapper->getTypeID(); }
-		size_t getSize() const { return m_virtualTypeWrapper->getSize(); }
+		TypeID getTypeID() const { return m_typeID; }
+		size_t getSize() const { return m_size; }
+		size_t getAlignment() const { return m_alignment; }
+		uint8_t getFlags() const { return m_flags; }
+		bool hasFlags(uint8_t _flags) const { return (m_flags & _flags) == _flags; }
+		bool isTriviallyCopyable() const { return (m_flags & TypeFlag_TriviallyCopyable) != 0; }
 
-		// @TODO(2021/02/15|Remi): Allow the user to choose their allocator
-		bool hasFactory() const;
-		void* instantiate() const;
+		struct AllocationStats
+		{
+			size_t allocationCount = 0u;
+			size_t instanceCount = 0u;
+			size_t liveInstanceCount = 0u;
+			size_t allocatedBytes = 0u;
+		};
+
+		bool hasFactory() const { return (m_flags & TypeFlag_HasFactory) != 0; }
+
+		// Without allocator, the instance is created with new and can be deleted.
+		void* instantiate(Allocator* _allocator = nullptr) const;
+		// Constructs _count contiguous instances (getSize() apart) in a single allocation, from the default allocator when none is given.
+		void* instantiateN(size_t _count, Allocator* _allocator = nullptr) const;
+		// Constructs _count instances in caller memory, which must hold getSize() * _count bytes aligned on getAlignment()
+		void* instantiateAt(void* _memory, size_t _count = 1u) const;
+
+		// Destroy instances of this exact type, with the allocator given to instantiate / instantiateN.
+		// Allocators are only ever given explicitly, so that an instance is always freed the way it was allocated.
+		void destroy(void* _instance, Allocator* _allocator = nullptr) const;
+		void destroyN(void* _instances, size_t _count, Allocator* _allocator = nullptr) const;
+		void destroyAt(void* _instances, size_t _count = 1u) const;
+
+		AllocationStats getAllocationStats() const;
 
 	protected:
 		const VirtualTypeWrapper* getVirtualTypeWrapper() const { return m_virtualTypeWrapper; }
+		void setVirtualTypeWrapper(VirtualTypeWrapper* _virtualTypeWrapper);
 		void setName(const char* _name);
 
 	private:
+		void copyVirtualTypeWrapperFields();
+
+		// Hot fields
+		TypeID m_typeID = UNDEFINED_TYPEID;
+		uint32_t m_size = 0u;
+		uint16_t m_alignment = 0u;
+		uint8_t m_type = Type_none;
+		uint8_t m_flags = TypeFlag_None;
+
+		// Cold fields, filling the rest of the first cache line
 		char* m_name;
-		Type m_type = Type_none;
 		VirtualTypeWrapper* m_virtualTypeWrapper = nullptr;
+
+		// Written by each instantiation, possibly from several threads: kept on a cache line of their own so that they do not invalidate the hot fields
+		struct alignas(64) AllocationCounters
+		{
+			std::atomic<size_t> allocationCount = { 0u };
+			std::atomic<size_t> instanceCount = { 0u };
+			std::atomic<size_t> destroyedInstanceCount = { 0u };
+			std::atomic<size_t> allocatedBytes = { 0u };
+		};
+		mutable AllocationCounters m_allocationCounters;
 	};
 
 	class MIRROR_API PointerTypeDesc : public TypeDesc
 	{
 	public:
-		PointerTypeDesc(TypeID _subType, VirtualTypeWrapper* _virtualTypeWrapper);
+		PointerTypeDesc(TypeID _subType, const char* _subTypeName, VirtualTypeWrapper* _virtualTypeWrapper);
 
 		TypeDesc* getSubType() const;
 
@@ -168,7 +249,7 @@ namespace mirror
 	class MIRROR_API FixedSizeArrayTypeDesc : public TypeDesc
 	{
 	public:
-		FixedSizeArrayTypeDesc(TypeID _subType, size_t _elementCount, VirtualTypeWrapper* _virtualTypeWrapper);
+		FixedSizeArrayTypeDesc(const char* _name, TypeID _subType, size_t _elementCount, VirtualTypeWrapper* _virtualTypeWrapper);
 
 		TypeDesc* getSubType() const;
 		size_t getElementCount() const { return m_elementCount; }
@@ -222,6 +303,9 @@ namespace mirror
 
 		const MetaDataSet& getMetaDataSet() const { return m_metaDataSet; }
 
+		// Used by MIRROR_FACTORY to give the class a wrapper able to instantiate it
+		void setVirtualTypeWrapper(VirtualTypeWrapper* _virtualTypeWrapper) { TypeDesc::setVirtualTypeWrapper(_virtualTypeWrapper); }
+
 		Class* unsafeVirtualGetClass(void* _object) const;
 
 	private:
@@ -324,6 +408,24 @@ namespace mirror
 		std::unordered_map<uint32_t, TypeDesc*> m_typesByName;
 	};
 
+	// Registers a type description built from the given arguments, for types that have no dedicated initializer
+	template <typename TypeDescType>
+	struct GenericTypeDescInitializer
+	{
+		template <typename... Args>
+		GenericTypeDescInitializer(Args... _args)
+		{
+			typeDesc = new TypeDescType(_args...);
+			GetTypeSet()->addType(typeDesc);
+		}
+		~GenericTypeDescInitializer()
+		{
+			GetTypeSet()->removeType(typeDesc);
+			delete typeDesc;
+		}
+		TypeDescType* typeDesc = nullptr;
+	};
+
 	template <typename T, typename IsArray = void, typename IsPointer = void, typename IsEnum = void, typename IsFunction = void>
 	struct TypeDescGetter
 	{
@@ -334,14 +436,49 @@ namespace mirror
 		}
 	};
 
+	// Sub types (pointed types, elements, keys...) may be classes not registered yet, in which case their TypeID is still known
+	template <typename T>
+	TypeID GetSubTypeID()
+	{
+		TypeDesc* typeDesc = TypeDescGetter<T>::Get();
+		return typeDesc ? typeDesc->getTypeID() : GetTypeID<T>();
+	}
+
+	// Name declared by MIRROR_CLASS, known before the class is registered
+	template <typename T, typename = void>
+	struct ClassNameGetter
+	{
+		static const char* Get() { return nullptr; }
+	};
+
+	template <typename T>
+	struct ClassNameGetter<T, decltype(void(T::__MirrorGetClassName()))>
+	{
+		static const char* Get() { return T::__MirrorGetClassName(); }
+	};
+
+	// Sub types are named as they are registered, whether or not they already are, so that the names of the types built on them
+	// do not depend on the order of initialization. Only types that are not reflected fall back to their compiler specific name.
+	template <typename T>
+	std::string GetSubTypeName()
+	{
+		TypeDesc* typeDesc = TypeDescGetter<T>::Get();
+		if (typeDesc)
+			return typeDesc->getName();
+		const char* className = ClassNameGetter<T>::Get();
+		return className ? className : typeid(T).name();
+	}
+
 	template <typename T>
 	struct TypeDescGetter<T, std::enable_if_t<std::is_array<T>::value>>
 	{
 		static TypeDesc* Get()
 		{
 			using type = typename typename std::remove_extent<T>::type;
-			static FixedSizeArrayTypeDesc s_fixedSizeArrayTypeDesc(TypeDescGetter<type>::Get(), std::extent<T>::value , new TVirtualTypeWrapper<T>());
-			return &s_fixedSizeArrayTypeDesc;
+			static GenericTypeDescInitializer<FixedSizeArrayTypeDesc> s_initializer(
+				(GetSubTypeName<type>() + "[" + std::to_string(std::extent<T>::value) + "]").c_str(),
+				GetSubTypeID<type>(), std::extent<T>::value, new TVirtualTypeWrapper<T>());
+			return s_initializer.typeDesc;
 		}
 	};
 
@@ -355,7 +492,7 @@ namespace mirror
 			if (!typeDesc)
 			{
 				using type = typename std::remove_pointer<T>::type;
-				PointerTypeDesc* pointerTypeDesc = new PointerTypeDesc(TypeDescGetter<type>::Get()->getTypeID(), new TVirtualTypeWrapper<T>());
+				PointerTypeDesc* pointerTypeDesc = new PointerTypeDesc(GetSubTypeID<type>(), GetSubTypeName<type>().c_str(), new TVirtualTypeWrapper<T>());
 				GetTypeSet()->addType(pointerTypeDesc);
 				typeDesc = pointerTypeDesc;
 			}*/
@@ -634,7 +771,7 @@ namespace mirror
 		PointerTypeDescInitializer()
 		{
 			using type = typename std::remove_pointer<T>::type;
-			typeDesc = new PointerTypeDesc(TypeDescGetter<type>::Get()->getTypeID(), new TVirtualTypeWrapper<T>());
+			typeDesc = new PointerTypeDesc(GetSubTypeID<type>(), GetSubTypeName<type>().c_str(), new TVirtualTypeWrapper<T>());
 			GetTypeSet()->addType(typeDesc);
 		}
 		~PointerTypeDescInitializer()
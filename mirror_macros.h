@@ -15,6 +15,7 @@ public:\
 
 #define __MIRROR_CLASS_CONSTRUCTION(_class, ...)\
 	static ::mirror::Class* GetClass() { return ::mirror::GetClass<_class>(); }\
+	static const char* __MirrorGetClassName() { return #_class; }\
 	\
 	static ::mirror::ClassInitializer<_class, false> __MirrorInitializer;\
 	static ::mirror::Class* __MirrorCreateClass()\
@@ -49,6 +50,11 @@ public:\
 		clss->addMember(classMember);\
 	}
 
+#define MIRROR_FACTORY()\
+	{\
+		clss->setVirtualTypeWrapper(new ::mirror::TVirtualTypeWrapper<classType, true, true>());\
+	}
+
 #define MIRROR_PARENT(_parentClass)\
 	{\
 		clss->addParent(::mirror::GetClass<_parentClass>());\
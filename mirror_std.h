@@ -1,45 +1,280 @@
 #pragma once
 
+#include <array>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+#ifdef __cpp_lib_span
+#include <span>
+#endif
+
 #include "mirror_base.h"
 
 namespace mirror
 {
+	// These classes are used as proxies to access the containers' methods without knowing their types.
+	// More methods can be added if needed
+
 	class StdVectorTypeDesc : public TypeDesc
 	{
 	public:
+		// Contiguous elements of a vector instance, valid until the vector is modified
+		struct Span
+		{
+			void* data = nullptr;
+			size_t size = 0u;
+			size_t elementSize = 0u;
+			size_t stride = 0u;
+			bool isTriviallyCopyable = false;
 
-		StdVectorTypeDesc(VirtualTypeWrapper* _virtualTypeWrapper) : TypeDesc(Type_std_vector, "std::vector", _virtualTypeWrapper) {}
+			void* at(size_t _index) const { return reinterpret_cast<uint8_t*>(data) + _index * stride; }
+			size_t getByteSize() const { return size * stride; }
+		};
+
+		StdVectorTypeDesc(const char* _name, TypeID _subType, size_t _elementSize, bool _isElementTriviallyCopyable, VirtualTypeWrapper* _virtualTypeWrapper)
+			: TypeDesc(Type_std_vector, _name, _virtualTypeWrapper), m_subType(_subType), m_elementSize(_elementSize), m_isElementTriviallyCopyable(_isElementTriviallyCopyable) {}
 
 		virtual void instanceResize(void* _instance, size_t _size) const = 0;
+		virtual void instanceReserve(void* _instance, size_t _capacity) const = 0;
 		virtual size_t instanceSize(void* _instance) const = 0;
 		virtual void* instanceGetDataPointerAt(void* _instance, size_t _index) const = 0;
-		TypeDesc* getSubType() const { return m_subType; }
+		virtual Span instanceGetSpan(void* _instance) const = 0;
+		TypeDesc* getSubType() const { return GetTypeSet()->findTypeByID(m_subType); }
+
+		size_t getElementSize() const { return m_elementSize; }
+		bool isElementTriviallyCopyable() const { return m_isElementTriviallyCopyable; }
 
 	protected:
-		TypeDesc* m_subType = nullptr;
+		TypeID m_subType = UNDEFINED_TYPEID;
+		size_t m_elementSize;
+		bool m_isElementTriviallyCopyable;
+	};
+
+	class StdPairTypeDesc : public TypeDesc
+	{
+	public:
+		StdPairTypeDesc(const char* _name, TypeID _firstType, size_t _firstOffset, TypeID _secondType, size_t _secondOffset, VirtualTypeWrapper* _virtualTypeWrapper)
+			: TypeDesc(Type_std_pair, _name, _virtualTypeWrapper)
+			, m_firstType(_firstType), m_secondType(_secondType), m_firstOffset(_firstOffset), m_secondOffset(_secondOffset) {}
+
+		TypeDesc* getFirstType() const { return GetTypeSet()->findTypeByID(m_firstType); }
+		TypeDesc* getSecondType() const { return GetTypeSet()->findTypeByID(m_secondType); }
+
+		void* instanceGetFirst(void* _instance) const { return reinterpret_cast<uint8_t*>(_instance) + m_firstOffset; }
+		void* instanceGetSecond(void* _instance) const { return reinterpret_cast<uint8_t*>(_instance) + m_secondOffset; }
+
+	private:
+		TypeID m_firstType = UNDEFINED_TYPEID;
+		TypeID m_secondType = UNDEFINED_TYPEID;
+		size_t m_firstOffset;
+		size_t m_secondOffset;
+	};
+
+	class StdOptionalTypeDesc : public TypeDesc
+	{
+	public:
+		StdOptionalTypeDesc(const char* _name, TypeID _subType, VirtualTypeWrapper* _virtualTypeWrapper)
+			: TypeDesc(Type_std_optional, _name, _virtualTypeWrapper), m_subType(_subType) {}
+
+		// Returns nullptr when the optional is empty
+		virtual void* instanceGetValue(void* _instance) const = 0;
+		// Replaces the content of the optional by a default constructed value, and returns it
+		virtual void* instanceEmplace(void* _instance) const = 0;
+		virtual void instanceReset(void* _instance) const = 0;
+		TypeDesc* getSubType() const { return GetTypeSet()->findTypeByID(m_subType); }
+
+	private:
+		TypeID m_subType = UNDEFINED_TYPEID;
+	};
+
+	class StdUniquePtrTypeDesc : public TypeDesc
+	{
+	public:
+		StdUniquePtrTypeDesc(const char* _name, TypeID _subType, VirtualTypeWrapper* _virtualTypeWrapper)
+			: TypeDesc(Type_std_unique_ptr, _name, _virtualTypeWrapper), m_subType(_subType) {}
+
+		virtual void* instanceGet(void* _instance) const = 0;
+		// Takes ownership of _object, which must have been allocated with new
+		virtual void instanceReset(void* _instance, void* _object) const = 0;
+		TypeDesc* getSubType() const { return GetTypeSet()->findTypeByID(m_subType); }
+
+	private:
+		TypeID m_subType = UNDEFINED_TYPEID;
+	};
+
+	// Shared by std::map and std::unordered_map
+	class StdMapTypeDesc : public TypeDesc
+	{
+	public:
+		struct Entry
+		{
+			const void* key;
+			void* value;
+		};
+
+		StdMapTypeDesc(Type _type, const char* _name, TypeID _keyType, TypeID _valueType, VirtualTypeWrapper* _virtualTypeWrapper)
+			: TypeDesc(_type, _name, _virtualTypeWrapper), m_keyType(_keyType), m_valueType(_valueType) {}
+
+		virtual size_t instanceSize(void* _instance) const = 0;
+		virtual void instanceClear(void* _instance) const = 0;
+		// Does nothing for ordered maps
+		virtual void instanceReserve(void* _instance, size_t _size) const = 0;
+		// Appends pointers to all keys and values of the instance in a single call
+		virtual void instanceGetEntries(void* _instance, std::vector<Entry>& _outEntries) const = 0;
+		// Moves _key into the instance and returns a pointer to its value, default constructed if the key was not present
+		virtual void* instanceInsert(void* _instance, void* _key) const = 0;
+
+		// Scratch key used to read a key before inserting it
+		virtual void* newKey() const = 0;
+		virtual void deleteKey(void* _key) const = 0;
+
+		TypeDesc* getKeyType() const { return GetTypeSet()->findTypeByID(m_keyType); }
+		TypeDesc* getValueType() const { return GetTypeSet()->findTypeByID(m_valueType); }
+
+	private:
+		TypeID m_keyType = UNDEFINED_TYPEID;
+		TypeID m_valueType = UNDEFINED_TYPEID;
+	};
+
+	// Views on contiguous arithmetic values, such as the ones of a memory mapped file (std::span<const T> when available)
+	class StdSpanTypeDesc : public TypeDesc
+	{
+	public:
+		StdSpanTypeDesc(const char* _name, TypeID _subType, size_t _elementSize, VirtualTypeWrapper* _virtualTypeWrapper)
+			: TypeDesc(Type_std_span, _name, _virtualTypeWrapper), m_subType(_subType), m_elementSize(_elementSize) {}
+
+		virtual StdVectorTypeDesc::Span instanceGetSpan(void* _instance) const = 0;
+		// The span does not own _data
+		virtual void instanceSet(void* _instance, const void* _data, size_t _size) const = 0;
+		TypeDesc* getSubType() const { return GetTypeSet()->findTypeByID(m_subType); }
+
+		size_t getElementSize() const { return m_elementSize; }
+
+	private:
+		TypeID m_subType = UNDEFINED_TYPEID;
+		size_t m_elementSize;
 	};
+
 	template <typename T>
 	class TStdVectorTypeDesc : public StdVectorTypeDesc
 	{
 	public:
 		TStdVectorTypeDesc();
 
-		// This class is used as a proxy to access vector's methods without knowing its type.
-		// More methods can be added if needed
 		virtual void instanceResize(void* _instance, size_t _size) const override;
+		virtual void instanceReserve(void* _instance, size_t _capacity) const override;
 		virtual size_t instanceSize(void* _instance) const override;
 		virtual void* instanceGetDataPointerAt(void* _instance, size_t _index) const override;
+		virtual Span instanceGetSpan(void* _instance) const override;
+	};
+
+	template <typename T1, typename T2>
+	class TStdPairTypeDesc : public StdPairTypeDesc
+	{
+	public:
+		using pair_type = std::pair<T1, T2>;
+
+		TStdPairTypeDesc();
+
+	private:
+		static size_t GetFirstOffset();
+		static size_t GetSecondOffset();
+	};
+
+	template <typename T>
+	class TStdOptionalTypeDesc : public StdOptionalTypeDesc
+	{
+	public:
+		TStdOptionalTypeDesc();
+
+		virtual void* instanceGetValue(void* _instance) const override;
+		virtual void* instanceEmplace(void* _instance) const override;
+		virtual void instanceReset(void* _instance) const override;
+	};
+
+	template <typename T>
+	class TStdUniquePtrTypeDesc : public StdUniquePtrTypeDesc
+	{
+	public:
+		TStdUniquePtrTypeDesc();
+
+		virtual void* instanceGet(void* _instance) const override;
+		virtual void instanceReset(void* _instance, void* _object) const override;
 	};
 
-	template <> struct TypeDescGetter<std::string> { static TypeDesc* Get() { static TypeDesc s_typeDesc = TypeDesc(Type_std_string, "std::string", new TVirtualTypeWrapper<std::string, true>()); return &s_typeDesc; } };
-	template <typename T> struct TypeDescGetter<std::vector<T>> { static TypeDesc* Get() { static TStdVectorTypeDesc<T> s_typeDesc(new TVirtualTypeWrapper<std::string, true>()); return &s_typeDesc; } };
+	template <typename MapType>
+	class TStdMapTypeDesc : public StdMapTypeDesc
+	{
+	public:
+		using key_type = typename MapType::key_type;
+		using mapped_type = typename MapType::mapped_type;
+
+		TStdMapTypeDesc(Type _type, const char* _templateName);
+
+		virtual size_t instanceSize(void* _instance) const override;
+		virtual void instanceClear(void* _instance) const override;
+		virtual void instanceReserve(void* _instance, size_t _size) const override;
+		virtual void instanceGetEntries(void* _instance, std::vector<Entry>& _outEntries) const override;
+		virtual void* instanceInsert(void* _instance, void* _key) const override;
+		virtual void* newKey() const override { return new key_type(); }
+		virtual void deleteKey(void* _key) const override { delete reinterpret_cast<key_type*>(_key); }
+	};
+
+	template <> struct TypeDescGetter<std::string> { static TypeDesc* Get() { static TypeDescInitializer<std::string, true> s_initializer(Type_std_string, "std::string"); return s_initializer.typeDesc; } };
+	template <> struct TypeDescGetter<std::string_view> { static TypeDesc* Get() { static TypeDescInitializer<std::string_view, true> s_initializer(Type_std_string_view, "std::string_view"); return s_initializer.typeDesc; } };
+	template <typename T> struct TypeDescGetter<std::vector<T>> { static TypeDesc* Get() { static GenericTypeDescInitializer<TStdVectorTypeDesc<T>> s_initializer; return s_initializer.typeDesc; } };
+	template <typename T1, typename T2> struct TypeDescGetter<std::pair<T1, T2>> { static TypeDesc* Get() { static GenericTypeDescInitializer<TStdPairTypeDesc<T1, T2>> s_initializer; return s_initializer.typeDesc; } };
+	template <typename T> struct TypeDescGetter<std::optional<T>> { static TypeDesc* Get() { static GenericTypeDescInitializer<TStdOptionalTypeDesc<T>> s_initializer; return s_initializer.typeDesc; } };
+	template <typename T> struct TypeDescGetter<std::unique_ptr<T>> { static TypeDesc* Get() { static GenericTypeDescInitializer<TStdUniquePtrTypeDesc<T>> s_initializer; return s_initializer.typeDesc; } };
+	template <typename K, typename V> struct TypeDescGetter<std::map<K, V>> { static TypeDesc* Get() { static GenericTypeDescInitializer<TStdMapTypeDesc<std::map<K, V>>> s_initializer(Type_std_map, "std::map"); return s_initializer.typeDesc; } };
+	template <typename K, typename V> struct TypeDescGetter<std::unordered_map<K, V>> { static TypeDesc* Get() { static GenericTypeDescInitializer<TStdMapTypeDesc<std::unordered_map<K, V>>> s_initializer(Type_std_unordered_map, "std::unordered_map"); return s_initializer.typeDesc; } };
+
+#ifdef __cpp_lib_span
+	template <typename T>
+	class TStdSpanTypeDesc : public StdSpanTypeDesc
+	{
+	public:
+		using value_type = typename std::remove_const<T>::type;
+		static_assert(std::is_arithmetic<value_type>::value, "Only spans of arithmetic values are reflected");
+
+		TStdSpanTypeDesc();
+
+		virtual StdVectorTypeDesc::Span instanceGetSpan(void* _instance) const override;
+		virtual void instanceSet(void* _instance, const void* _data, size_t _size) const override;
+	};
+
+	template <typename T> struct TypeDescGetter<std::span<T>> { static TypeDesc* Get() { static GenericTypeDescInitializer<TStdSpanTypeDesc<T>> s_initializer; return s_initializer.typeDesc; } };
+#endif
+
+	// std::array has the layout of a fixed size array
+	template <typename T, size_t N> struct TypeDescGetter<std::array<T, N>>
+	{
+		static TypeDesc* Get()
+		{
+			static GenericTypeDescInitializer<FixedSizeArrayTypeDesc> s_initializer(
+				("std::array<" + GetSubTypeName<T>() + ", " + std::to_string(N) + ">").c_str(),
+				GetSubTypeID<T>(), N, new TVirtualTypeWrapper<std::array<T, N>, true>());
+			return s_initializer.typeDesc;
+		}
+	};
 }
 
 // INL
 template <typename T>
 mirror::TStdVectorTypeDesc<T>::TStdVectorTypeDesc()
+	: StdVectorTypeDesc(("std::vector<" + GetSubTypeName<T>() + ">").c_str(), GetSubTypeID<T>(), sizeof(T), std::is_trivially_copyable<T>::value, new TVirtualTypeWrapper<std::vector<T>, true>())
 {
-	m_subType = GetTypeDesc(T());
 }
 
 template <typename T>
@@ -59,3 +294,169 @@ void mirror::TStdVectorTypeDesc<T>::instanceResize(void* _instance, size_t _size
 {
 	reinterpret_cast<std::vector<T>*>(_instance)->resize(_size);
 }
+
+template <typename T>
+void mirror::TStdVectorTypeDesc<T>::instanceReserve(void* _instance, size_t _capacity) const
+{
+	reinterpret_cast<std::vector<T>*>(_instance)->reserve(_capacity);
+}
+
+template <typename T>
+mirror::StdVectorTypeDesc::Span mirror::TStdVectorTypeDesc<T>::instanceGetSpan(void* _instance) const
+{
+	std::vector<T>* vector = reinterpret_cast<std::vector<T>*>(_instance);
+	Span span;
+	span.data = vector->data();
+	span.size = vector->size();
+	span.elementSize = sizeof(T);
+	span.stride = sizeof(T);
+	span.isTriviallyCopyable = std::is_trivially_copyable<T>::value;
+	return span;
+}
+
+template <typename T1, typename T2>
+mirror::TStdPairTypeDesc<T1, T2>::TStdPairTypeDesc()
+	: StdPairTypeDesc(("std::pair<" + GetSubTypeName<T1>() + ", " + GetSubTypeName<T2>() + ">").c_str(),
+		GetSubTypeID<T1>(), GetFirstOffset(),
+		GetSubTypeID<T2>(), GetSecondOffset(),
+		new TVirtualTypeWrapper<std::pair<T1, T2>, true>())
+{
+}
+
+template <typename T1, typename T2>
+size_t mirror::TStdPairTypeDesc<T1, T2>::GetFirstOffset()
+{
+	alignas(pair_type) char fakePrototype[sizeof(pair_type)] = {};
+	pair_type* prototypePtr = reinterpret_cast<pair_type*>(fakePrototype);
+	return reinterpret_cast<size_t>(&prototypePtr->first) - reinterpret_cast<size_t>(prototypePtr);
+}
+
+template <typename T1, typename T2>
+size_t mirror::TStdPairTypeDesc<T1, T2>::GetSecondOffset()
+{
+	alignas(pair_type) char fakePrototype[sizeof(pair_type)] = {};
+	pair_type* prototypePtr = reinterpret_cast<pair_type*>(fakePrototype);
+	return reinterpret_cast<size_t>(&prototypePtr->second) - reinterpret_cast<size_t>(prototypePtr);
+}
+
+template <typename T>
+mirror::TStdOptionalTypeDesc<T>::TStdOptionalTypeDesc()
+	: StdOptionalTypeDesc(("std::optional<" + GetSubTypeName<T>() + ">").c_str(), GetSubTypeID<T>(), new TVirtualTypeWrapper<std::optional<T>, true>())
+{
+}
+
+template <typename T>
+void* mirror::TStdOptionalTypeDesc<T>::instanceGetValue(void* _instance) const
+{
+	std::optional<T>* optional = reinterpret_cast<std::optional<T>*>(_instance);
+	return optional->has_value() ? &optional->value() : nullptr;
+}
+
+template <typename T>
+void* mirror::TStdOptionalTypeDesc<T>::instanceEmplace(void* _instance) const
+{
+	return &reinterpret_cast<std::optional<T>*>(_instance)->emplace();
+}
+
+template <typename T>
+void mirror::TStdOptionalTypeDesc<T>::instanceReset(void* _instance) const
+{
+	reinterpret_cast<std::optional<T>*>(_instance)->reset();
+}
+
+template <typename T>
+mirror::TStdUniquePtrTypeDesc<T>::TStdUniquePtrTypeDesc()
+	: StdUniquePtrTypeDesc(("std::unique_ptr<" + GetSubTypeName<T>() + ">").c_str(), GetSubTypeID<T>(), new TVirtualTypeWrapper<std::unique_ptr<T>, true>())
+{
+}
+
+template <typename T>
+void* mirror::TStdUniquePtrTypeDesc<T>::instanceGet(void* _instance) const
+{
+	return reinterpret_cast<std::unique_ptr<T>*>(_instance)->get();
+}
+
+template <typename T>
+void mirror::TStdUniquePtrTypeDesc<T>::instanceReset(void* _instance, void* _object) const
+{
+	reinterpret_cast<std::unique_ptr<T>*>(_instance)->reset(reinterpret_cast<T*>(_object));
+}
+
+template <typename MapType>
+mirror::TStdMapTypeDesc<MapType>::TStdMapTypeDesc(Type _type, const char* _templateName)
+	: StdMapTypeDesc(_type, (std::string(_templateName) + "<" + GetSubTypeName<key_type>() + ", " + GetSubTypeName<mapped_type>() + ">").c_str(),
+		GetSubTypeID<key_type>(), GetSubTypeID<mapped_type>(), new TVirtualTypeWrapper<MapType, true>())
+{
+}
+
+template <typename MapType>
+size_t mirror::TStdMapTypeDesc<MapType>::instanceSize(void* _instance) const
+{
+	return reinterpret_cast<MapType*>(_instance)->size();
+}
+
+template <typename MapType>
+void mirror::TStdMapTypeDesc<MapType>::instanceClear(void* _instance) const
+{
+	reinterpret_cast<MapType*>(_instance)->clear();
+}
+
+namespace mirror
+{
+	template <typename MapType>
+	void StdMapReserve(MapType& _map, size_t _size) {}
+
+	template <typename K, typename V>
+	void StdMapReserve(std::unordered_map<K, V>& _map, size_t _size) { _map.reserve(_size); }
+}
+
+template <typename MapType>
+void mirror::TStdMapTypeDesc<MapType>::instanceReserve(void* _instance, size_t _size) const
+{
+	StdMapReserve(*reinterpret_cast<MapType*>(_instance), _size);
+}
+
+template <typename MapType>
+void mirror::TStdMapTypeDesc<MapType>::instanceGetEntries(void* _instance, std::vector<Entry>& _outEntries) const
+{
+	MapType* map = reinterpret_cast<MapType*>(_instance);
+	_outEntries.reserve(_outEntries.size() + map->size());
+	for (auto& pair : *map)
+	{
+		_outEntries.push_back({ &pair.first, &pair.second });
+	}
+}
+
+template <typename MapType>
+void* mirror::TStdMapTypeDesc<MapType>::instanceInsert(void* _instance, void* _key) const
+{
+	MapType* map = reinterpret_cast<MapType*>(_instance);
+	return &(*map)[std::move(*reinterpret_cast<key_type*>(_key))];
+}
+
+#ifdef __cpp_lib_span
+template <typename T>
+mirror::TStdSpanTypeDesc<T>::TStdSpanTypeDesc()
+	: StdSpanTypeDesc((std::string(std::is_const<T>::value ? "std::span<const " : "std::span<") + GetSubTypeName<value_type>() + ">").c_str(), GetSubTypeID<value_type>(), sizeof(T), new TVirtualTypeWrapper<std::span<T>, true>())
+{
+}
+
+template <typename T>
+mirror::StdVectorTypeDesc::Span mirror::TStdSpanTypeDesc<T>::instanceGetSpan(void* _instance) const
+{
+	std::span<T>* span = reinterpret_cast<std::span<T>*>(_instance);
+	StdVectorTypeDesc::Span result;
+	result.data = const_cast<value_type*>(span->data());
+	result.size = span->size();
+	result.elementSize = sizeof(T);
+	result.stride = sizeof(T);
+	result.isTriviallyCopyable = true;
+	return result;
+}
+
+template <typename T>
+void mirror::TStdSpanTypeDesc<T>::instanceSet(void* _instance, const void* _data, size_t _size) const
+{
+	*reinterpret_cast<std::span<T>*>(_instance) = std::span<T>(reinterpret_cast<T*>(const_cast<void*>(_data)), _size);
+}
+#endif
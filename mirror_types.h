@@ -24,7 +24,14 @@ namespace mirror
 		Type_Enum,
 
 		Type_std_string,
+		Type_std_string_view,
 		Type_std_vector,
+		Type_std_pair,
+		Type_std_optional,
+		Type_std_unique_ptr,
+		Type_std_map,
+		Type_std_unordered_map,
+		Type_std_span,
 
 		Type_Class,
 
@@ -35,4 +42,13 @@ namespace mirror
 
 		Type_COUNT,
 	};
+
+	enum TypeFlag
+	{
+		TypeFlag_None = 0,
+
+		TypeFlag_TriviallyCopyable = 1 << 0,
+		TypeFlag_HasFactory = 1 << 1,
+		TypeFlag_Polymorphic = 1 << 2,
+	};
 }
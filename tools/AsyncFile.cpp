@@ -0,0 +1,200 @@
+#include "AsyncFile.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace mirror
+{
+	AsyncOperation::AsyncOperation(std::function<bool(const AsyncOperation& _operation)> _function)
+	{
+		// Started once the members are initialized
+		m_thread = std::thread([this, function = std::move(_function)]()
+		{
+			m_isSucceeded = function(*this) && !isCancelled();
+			m_isDone.store(true, std::memory_order_release);
+		});
+	}
+
+	AsyncOperation::~AsyncOperation()
+	{
+		wait();
+	}
+
+	bool AsyncOperation::wait()
+	{
+		std::lock_guard<std::mutex> lock(m_waitMutex);
+		if (m_thread.joinable())
+			m_thread.join();
+		return m_isSucceeded;
+	}
+
+	AsyncWriteSink::AsyncWriteSink(OutputSink* _sink, size_t _bufferSize, const AsyncOperation* _operation)
+		: m_sink(_sink)
+		, m_bufferSize(_bufferSize)
+		, m_operation(_operation)
+	{
+		assert(m_sink);
+		assert(m_bufferSize > 0u);
+		m_fillBuffer.reserve(m_bufferSize);
+		m_writeBuffer.reserve(m_bufferSize);
+		m_thread = std::thread(&AsyncWriteSink::_run, this);
+	}
+
+	AsyncWriteSink::~AsyncWriteSink()
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return !m_isWritePending; });
+			m_isStopping = true;
+		}
+		m_condition.notify_all();
+		m_thread.join();
+	}
+
+	bool AsyncWriteSink::write(const OutputSegment* _segments, size_t _segmentCount)
+	{
+		if (m_operation && m_operation->isCancelled())
+			m_hasFailed = true;
+
+		for (size_t i = 0; i < _segmentCount && !m_hasFailed; ++i)
+		{
+			const uint8_t* data = reinterpret_cast<const uint8_t*>(_segments[i].data);
+			size_t size = _segments[i].size;
+			while (size > 0u)
+			{
+				size_t copiedSize = std::min(size, m_bufferSize - m_fillBuffer.size());
+				m_fillBuffer.insert(m_fillBuffer.end(), data, data + copiedSize);
+				data += copiedSize;
+				size -= copiedSize;
+				if (m_fillBuffer.size() == m_bufferSize)
+					_submit();
+			}
+		}
+		return !m_hasFailed;
+	}
+
+	bool AsyncWriteSink::finish()
+	{
+		if (!m_fillBuffer.empty() && !m_hasFailed)
+			_submit();
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_condition.wait(lock, [this]() { return !m_isWritePending; });
+		return !m_hasFailed;
+	}
+
+	void AsyncWriteSink::_submit()
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return !m_isWritePending; });
+			m_fillBuffer.swap(m_writeBuffer);
+			m_isWritePending = true;
+		}
+		m_condition.notify_all();
+		m_fillBuffer.clear();
+	}
+
+	void AsyncWriteSink::_run()
+	{
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_condition.wait(lock, [this]() { return m_isStopping || m_isWritePending; });
+				if (!m_isWritePending)
+					return;
+			}
+
+			// Written without the lock, while the next buffer is filled
+			if (!m_hasFailed)
+			{
+				OutputSegment segment = { m_writeBuffer.data(), m_writeBuffer.size() };
+				if (!m_sink->write(&segment, 1u))
+					m_hasFailed = true;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_isWritePending = false;
+			}
+			m_condition.notify_all();
+		}
+	}
+
+	AsyncFileReader::AsyncFileReader(FILE* _file, size_t _chunkSize)
+		: m_file(_file)
+	{
+		assert(m_file);
+		assert(_chunkSize > 0u);
+		m_buffers[0].resize(_chunkSize);
+		m_buffers[1].resize(_chunkSize);
+		m_thread = std::thread(&AsyncFileReader::_run, this);
+	}
+
+	AsyncFileReader::~AsyncFileReader()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_isStopping = true;
+		}
+		m_condition.notify_all();
+		m_thread.join();
+	}
+
+	bool AsyncFileReader::read(const uint8_t*& _outData, size_t& _outSize)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		// The chunk given by the previous call can be read into again
+		if (m_isChunkGiven)
+		{
+			m_sizes[m_readIndex ^ 1u] = 0u;
+			m_isChunkGiven = false;
+			m_condition.notify_all();
+		}
+
+		m_condition.wait(lock, [this]() { return m_sizes[m_readIndex] > 0u || m_isEnded || m_hasFailed; });
+		if (m_hasFailed)
+			return false;
+
+		_outData = m_buffers[m_readIndex].data();
+		_outSize = m_sizes[m_readIndex];
+		if (_outSize > 0u)
+		{
+			m_isChunkGiven = true;
+			m_readIndex ^= 1u;
+		}
+		return true;
+	}
+
+	void AsyncFileReader::_run()
+	{
+		size_t writeIndex = 0u;
+		for (;;)
+		{
+			{
+				// Waits for the buffer to be neither read nor given
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_condition.wait(lock, [this, writeIndex]() { return m_isStopping || m_sizes[writeIndex] == 0u; });
+				if (m_isStopping)
+					return;
+			}
+
+			std::vector<uint8_t>& buffer = m_buffers[writeIndex];
+			size_t size = fread(buffer.data(), 1u, buffer.size(), m_file);
+			bool isEnded = size < buffer.size();
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_sizes[writeIndex] = size;
+				m_isEnded = isEnded;
+				m_hasFailed = isEnded && ferror(m_file) != 0;
+			}
+			m_condition.notify_all();
+			if (isEnded)
+				return;
+			writeIndex ^= 1u;
+		}
+	}
+}
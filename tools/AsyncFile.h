@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "OutputSink.h"
+
+namespace mirror
+{
+	// Work running on its own thread, e.g. a save started with SaveToFileAsync. Destroying the operation waits for it.
+	class AsyncOperation
+	{
+	public:
+		// Starts a thread calling _function, which returns whether it succeeded and checks isCancelled() from time to time
+		AsyncOperation(std::function<bool(const AsyncOperation& _operation)> _function);
+		~AsyncOperation();
+
+		bool isDone() const { return m_isDone.load(std::memory_order_acquire); }
+		// Waits until the operation is done, and returns whether it succeeded. Cancelled operations do not succeed.
+		bool wait();
+
+		// Asks the operation to stop as soon as it can
+		void cancel() { m_isCancelled.store(true, std::memory_order_relaxed); }
+		bool isCancelled() const { return m_isCancelled.load(std::memory_order_relaxed); }
+
+	private:
+		std::thread m_thread;
+		std::mutex m_waitMutex;
+		std::atomic<bool> m_isDone = { false };
+		std::atomic<bool> m_isCancelled = { false };
+		bool m_isSucceeded = false;
+	};
+
+	// Writes to _sink from a thread of its own: the bytes written go to a buffer of _bufferSize bytes, which is written while the next one is filled.
+	// Fails once _operation, when not null, is cancelled.
+	class AsyncWriteSink : public OutputSink
+	{
+	public:
+		AsyncWriteSink(OutputSink* _sink, size_t _bufferSize, const AsyncOperation* _operation = nullptr);
+		~AsyncWriteSink();
+
+		virtual bool write(const OutputSegment* _segments, size_t _segmentCount) override;
+		virtual bool hasFailed() const override { return m_hasFailed || (m_operation && m_operation->isCancelled()); }
+		// Writes the last buffer, and returns once _sink has everything. Returns false when a write failed.
+		bool finish();
+
+	private:
+		void _run();
+		// Hands the filled buffer to the thread, once it wrote the previous one
+		void _submit();
+
+		OutputSink* m_sink;
+		size_t m_bufferSize;
+		const AsyncOperation* m_operation;
+		std::vector<uint8_t> m_fillBuffer;
+		std::vector<uint8_t> m_writeBuffer;
+
+		std::thread m_thread;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		bool m_isWritePending = false;
+		bool m_isStopping = false;
+		std::atomic<bool> m_hasFailed = { false };
+	};
+
+	// Reads _file by chunks of _chunkSize bytes from a thread of its own, the next chunk being read while the current one is used
+	class AsyncFileReader
+	{
+	public:
+		AsyncFileReader(FILE* _file, size_t _chunkSize);
+		~AsyncFileReader();
+
+		// Gives the next chunk, valid until the next call, and an empty one at the end of the file. Returns false when reading failed.
+		bool read(const uint8_t*& _outData, size_t& _outSize);
+
+	private:
+		void _run();
+
+		FILE* m_file;
+		std::vector<uint8_t> m_buffers[2];
+		size_t m_sizes[2] = {}; // Of the buffers read and not given back yet, 0 for the free ones
+		size_t m_readIndex = 0u; // Buffer given by the next read()
+		bool m_isChunkGiven = false; // The other buffer is being used by the caller
+
+		std::thread m_thread;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		bool m_isEnded = false;
+		bool m_hasFailed = false;
+		bool m_isStopping = false;
+	};
+}
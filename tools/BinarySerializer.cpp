@@ -1,127 +1,3582 @@
 #include "BinarySerializer.h"
+#include "ThreadPool.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <limits>
+#include <unordered_set>
 #include "../mirror.h"
 
 namespace mirror
 {
+	static const uint8_t CompactFormatMagic[4] = { 0x89, 'M', 'R', 'B' };
+	static const size_t CompactFormatHeaderSize = sizeof(CompactFormatMagic) + 2u; // Magic, version, flags
+
+	enum CompactFlag : uint8_t
+	{
+		CompactFlag_Compressed = 1u << 0, // Followed by the id of the compressor, then the blocks of the uncompressed data
+	};
+	static const size_t CompressedHeaderSize = CompactFormatHeaderSize + 1u;
+
+	enum CompactRecord : uint8_t
+	{
+		CompactRecord_Names = 1,
+		CompactRecord_Entry = 2,
+		CompactRecord_Schemas = 3, // Class name hash, fingerprint and members of the classes used by the next entries
+	};
+
+	// Size of the varints reserved for the lengths patched after writing the data they prefix, enough for 256MB
+	static const size_t PaddedLengthSize = 4u;
+
+	// First allocation of the buffers written to, which then double
+	static const size_t MinDataAllocatedSize = 4096u;
+
+	static size_t GetVarintSize(uint64_t _value)
+	{
+		size_t size = 1u;
+		while (_value >= 0x80u)
+		{
+			_value >>= 7;
+			++size;
+		}
+		return size;
+	}
+
+	static size_t WriteVarint(uint8_t* _bytes, uint64_t _value)
+	{
+		size_t size = 0u;
+		while (_value >= 0x80u)
+		{
+			_bytes[size++] = static_cast<uint8_t>(_value) | 0x80u;
+			_value >>= 7;
+		}
+		_bytes[size++] = static_cast<uint8_t>(_value);
+		return size;
+	}
+
+	// Writes _value on exactly _size bytes, with continuation bits on the leading ones
+	static void WritePaddedVarint(uint8_t* _bytes, uint64_t _value, size_t _size)
+	{
+		for (size_t i = 0; i + 1 < _size; ++i)
+		{
+			_bytes[i] = static_cast<uint8_t>(_value & 0x7Fu) | 0x80u;
+			_value >>= 7;
+		}
+		assert(_value < 0x80u);
+		_bytes[_size - 1] = static_cast<uint8_t>(_value);
+	}
+
+	static bool ReadVarint(const uint8_t* _bytes, size_t _size, size_t& _cursor, uint64_t& _outValue)
+	{
+		uint64_t value = 0u;
+		for (unsigned shift = 0u; shift < 64u && _cursor < _size; shift += 7u)
+		{
+			uint8_t byte = _bytes[_cursor++];
+			value |= static_cast<uint64_t>(byte & 0x7Fu) << shift;
+			if ((byte & 0x80u) == 0u)
+			{
+				_outValue = value;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static uint64_t ZigZagEncode(int64_t _value)
+	{
+		return (static_cast<uint64_t>(_value) << 1) ^ static_cast<uint64_t>(_value >> 63);
+	}
+
+	static int64_t ZigZagDecode(uint64_t _value)
+	{
+		return static_cast<int64_t>(_value >> 1) ^ -static_cast<int64_t>(_value & 1u);
+	}
+
+	static int64_t GetEnumValue(const Enum* _enum, const void* _object)
+	{
+		switch (_enum->getSubType()->getType())
+		{
+		case Type_int8: return static_cast<int64_t>(*reinterpret_cast<const int8_t*>(_object));
+		case Type_int16: return static_cast<int64_t>(*reinterpret_cast<const int16_t*>(_object));
+		case Type_int32: return static_cast<int64_t>(*reinterpret_cast<const int32_t*>(_object));
+		case Type_int64: return static_cast<int64_t>(*reinterpret_cast<const int64_t*>(_object));
+		default: assert(false); return 0;
+		}
+	}
+
+	static void SetEnumValue(const Enum* _enum, void* _object, int64_t _value)
+	{
+		switch (_enum->getSubType()->getType())
+		{
+		case Type_int8: *reinterpret_cast<int8_t*>(_object) = static_cast<int8_t>(_value); break;
+		case Type_int16: *reinterpret_cast<int16_t*>(_object) = static_cast<int16_t>(_value); break;
+		case Type_int32: *reinterpret_cast<int32_t*>(_object) = static_cast<int32_t>(_value); break;
+		case Type_int64: *reinterpret_cast<int64_t*>(_object) = static_cast<int64_t>(_value); break;
+		default: assert(false); break;
+		}
+	}
 
 	BinarySerializer::BinarySerializer()
 	{
 
 	}
 
-	BinarySerializer::~BinarySerializer()
+	BinarySerializer::~BinarySerializer()
+	{
+		assert(!m_isReading);
+		assert(!m_isWriting);
+
+		if (m_writeDataBuffer)
+			_releaseDataBufferToPool(m_writeDataBuffer);
+
+		for (auto& pair : m_classPlans)
+		{
+			delete pair.second;
+		}
+
+		for (auto& pair : m_rawLayouts)
+		{
+			delete pair.second;
+		}
+
+		for (ParallelWorker* worker : m_parallelWorkers)
+		{
+			delete worker;
+		}
+
+		delete m_threadPool;
+		delete m_viewAllocator;
+		delete m_compressingSink;
+	}
+
+	void BinarySerializer::beginWrite()
+	{
+		assert(!m_isReading);
+		assert(!m_isWriting);
+
+		m_isWriting = true;
+
+		if (!m_writeDataBuffer)
+		{
+			m_writeDataBuffer = _getDataBufferFromPool();
+		}
+		else
+		{
+			m_writeDataBuffer->resetSegments();
+			m_writeDataBuffer->dataLength = 0;
+			m_writeDataBuffer->cursor = 0;
+		}
+		m_writeDataBuffer->baseOffset = 0u;
+		m_writeDataBuffer->stream = nullptr;
+
+		m_writeNameIndices.clear();
+		m_writeNames.clear();
+		m_writeSchemaClasses.clear();
+		m_parallelEntries.clear();
+		m_isWriteDataCompressed = false;
+		m_hasWriteFailed = false;
+
+		uint8_t version = CompactFormatVersion;
+		uint8_t flags = 0u;
+		m_writeDataBuffer->write(CompactFormatMagic, sizeof(CompactFormatMagic));
+		m_writeDataBuffer->write(version);
+		m_writeDataBuffer->write(flags);
+	}
+
+	void BinarySerializer::beginWrite(OutputSink* _sink, size_t _chunkSize)
+	{
+		assert(_sink);
+		assert(_chunkSize > 0u);
+
+		beginWrite();
+
+		m_writeStream = FLengthStream();
+		m_writeStream.sink = _sink;
+		m_writeStream.chunkSize = _chunkSize;
+		m_writeDataBuffer->stream = &m_writeStream;
+
+		if (m_compressor)
+		{
+			// The header is written as is, the data after it by blocks
+			uint8_t header[CompressedHeaderSize];
+			_writeCompressedHeader(header);
+			OutputSegment segment = { header, sizeof(header) };
+			m_writeStream.hasSinkFailed = !_sink->write(&segment, 1u);
+
+			delete m_compressingSink;
+			m_compressingSink = new CompressingSink(_sink, m_compressor, m_compressionBlockSize);
+			m_writeStream.sink = m_compressingSink;
+		}
+	}
+
+	bool BinarySerializer::endWrite()
+	{
+		assert(m_isWriting);
+
+		if (!m_parallelEntries.empty())
+			_writeParallelEntries();
+		m_isWriting = false;
+
+		if (!m_writeDataBuffer->stream)
+		{
+			if (m_compressor)
+				_compressWriteData();
+			return !m_hasWriteFailed;
+		}
+
+		assert(m_writeStream.openSlots.empty());
+		m_writeDataBuffer->flush();
+		m_writeDataBuffer->stream = nullptr;
+
+		if (m_compressingSink)
+		{
+			if (!m_writeStream.hasSinkFailed && !m_compressingSink->finish())
+				m_writeStream.hasSinkFailed = true;
+			delete m_compressingSink;
+			m_compressingSink = nullptr;
+		}
+
+		// Everything was flushed, the buffer goes back to the pool for the other serializers
+		_releaseDataBufferToPool(m_writeDataBuffer);
+		m_writeDataBuffer = nullptr;
+		return !m_writeStream.hasSinkFailed && !m_hasWriteFailed;
+	}
+
+	void BinarySerializer::setWriteThreadCount(size_t _threadCount)
+	{
+		assert(!m_isWriting);
+
+		m_writeThreadCount = std::max<size_t>(_threadCount, 1u);
+		if (m_threadPool && m_threadPool->getThreadCount() != m_writeThreadCount)
+		{
+			delete m_threadPool;
+			m_threadPool = nullptr;
+		}
+	}
+
+	void BinarySerializer::setWriteSegmentSize(size_t _segmentSize)
+	{
+		assert(!m_isWriting);
+
+		m_writeSegmentSize = std::max<size_t>(_segmentSize, 1u);
+	}
+
+	void BinarySerializer::setCompressor(const Compressor* _compressor, size_t _blockSize)
+	{
+		assert(!m_isWriting);
+
+		m_compressor = _compressor;
+		m_compressionBlockSize = std::max<size_t>(_blockSize, 1u);
+	}
+
+	void BinarySerializer::_writeCompressedHeader(uint8_t* _outHeader) const
+	{
+		memcpy(_outHeader, CompactFormatMagic, sizeof(CompactFormatMagic));
+		_outHeader[sizeof(CompactFormatMagic)] = CompactFormatVersion;
+		_outHeader[sizeof(CompactFormatMagic) + 1u] = CompactFlag_Compressed;
+		_outHeader[CompactFormatHeaderSize] = m_compressor->getId();
+	}
+
+	void BinarySerializer::_compressWriteData()
+	{
+		// Blocks are cut from the whole data
+		m_writeDataBuffer->join();
+		const uint8_t* data = m_writeDataBuffer->data;
+		size_t dataLength = m_writeDataBuffer->dataLength;
+		size_t blockSize = m_compressionBlockSize;
+		size_t blockCount = (dataLength + blockSize - 1u) / blockSize;
+
+		m_compressedWriteData.resize(CompressedHeaderSize);
+		_writeCompressedHeader(m_compressedWriteData.data());
+		if (m_writeThreadCount > 1u && blockCount > 1u)
+		{
+			// Blocks are independent, compressed by each thread then appended in order
+			if (!m_threadPool)
+				m_threadPool = new ThreadPool(m_writeThreadCount);
+			m_compressedBlocks.resize(blockCount);
+			m_threadPool->parallelFor(blockCount, [this, data, dataLength, blockSize](size_t _index, size_t)
+			{
+				size_t offset = _index * blockSize;
+				m_compressedBlocks[_index].clear();
+				AppendCompressedBlock(m_compressor, data + offset, std::min(blockSize, dataLength - offset), m_compressedBlocks[_index]);
+			});
+			for (size_t i = 0; i < blockCount; ++i)
+			{
+				m_compressedWriteData.insert(m_compressedWriteData.end(), m_compressedBlocks[i].begin(), m_compressedBlocks[i].end());
+			}
+		}
+		else
+		{
+			for (size_t offset = 0u; offset < dataLength; offset += blockSize)
+			{
+				AppendCompressedBlock(m_compressor, data + offset, std::min(blockSize, dataLength - offset), m_compressedWriteData);
+			}
+		}
+		m_isWriteDataCompressed = true;
+	}
+
+	bool BinarySerializer::_decompress(const uint8_t* _data, size_t _dataLength)
+	{
+		m_decompressedData.clear();
+		const Compressor* compressor = FindCompressor(_data[CompactFormatHeaderSize]);
+		if (!compressor)
+			return false;
+
+		// Sized from the block headers first, to decompress in place
+		size_t decompressedSize = 0u;
+		for (size_t cursor = CompressedHeaderSize; cursor < _dataLength;)
+		{
+			size_t headerSize = 0u, size = 0u, storedSize = 0u;
+			if (!ReadCompressedBlockHeader(compressor, _data + cursor, _dataLength - cursor, headerSize, size, storedSize) || storedSize > _dataLength - cursor - headerSize)
+				return false;
+			if (size > SIZE_MAX - decompressedSize)
+				return false;
+			decompressedSize += size;
+			cursor += headerSize + storedSize;
+		}
+
+		m_decompressedData.resize(decompressedSize);
+		size_t position = 0u;
+		for (size_t cursor = CompressedHeaderSize; cursor < _dataLength;)
+		{
+			size_t headerSize = 0u, size = 0u, storedSize = 0u;
+			ReadCompressedBlockHeader(compressor, _data + cursor, _dataLength - cursor, headerSize, size, storedSize);
+			if (!DecompressBlock(compressor, _data + cursor + headerSize, storedSize, m_decompressedData.data() + position, size))
+				return false;
+			position += size;
+			cursor += headerSize + storedSize;
+		}
+		return true;
+	}
+
+	void BinarySerializer::getWriteData(const void*& _outData, size_t& _outDataLength) const
+	{
+		if (m_isWriteDataCompressed)
+		{
+			_outData = m_compressedWriteData.data();
+			_outDataLength = m_compressedWriteData.size();
+		}
+		else if (m_writeDataBuffer)
+		{
+			m_writeDataBuffer->join();
+			_outData = m_writeDataBuffer->data;
+			_outDataLength = m_writeDataBuffer->dataLength;
+		}
+		else
+		{
+			_outData = nullptr;
+			_outDataLength = 0u;
+		}
+	}
+
+	void BinarySerializer::getWriteSegments(std::vector<OutputSegment>& _outSegments) const
+	{
+		_outSegments.clear();
+		if (m_isWriteDataCompressed)
+		{
+			_outSegments.push_back({ m_compressedWriteData.data(), m_compressedWriteData.size() });
+		}
+		else if (m_writeDataBuffer)
+		{
+			for (const FDataBuffer::Segment& segment : m_writeDataBuffer->sealedSegments)
+			{
+				_outSegments.push_back({ segment.data, segment.size });
+			}
+			if (m_writeDataBuffer->dataLength > 0u)
+				_outSegments.push_back({ m_writeDataBuffer->data, m_writeDataBuffer->dataLength });
+		}
+	}
+
+	void BinarySerializer::beginRead(const void* _data, size_t _dataLength)
+	{
+		assert(!m_isReading);
+		assert(!m_isWriting);
+
+		// Compressed data is read as the data it decompresses to, and as empty data when it cannot be decompressed
+		m_hasReadFailed = false;
+		m_isReadingDecompressedData = false;
+		m_hasReadEntry = false;
+		const uint8_t* data = reinterpret_cast<const uint8_t*>(_data);
+		if (_dataLength >= CompressedHeaderSize && memcmp(data, CompactFormatMagic, sizeof(CompactFormatMagic)) == 0 && (data[CompactFormatHeaderSize - 1u] & CompactFlag_Compressed) != 0u)
+		{
+			m_isReadingDecompressedData = true;
+			bool isDecompressed = _decompress(data, _dataLength);
+			_data = m_decompressedData.data();
+			_dataLength = isDecompressed ? m_decompressedData.size() : 0u;
+			m_hasReadFailed = !isDecompressed;
+		}
+
+		m_readDataBuffer = FDataBuffer(const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(_data)), _dataLength);
+		m_readEntryIndex = EntryIndex();
+		m_readNames.clear();
+		m_readSchemas.clear();
+		++m_readSchemaGeneration;
+		if (m_viewAllocator)
+			m_viewAllocator->reset();
+
+		// Data without the header is in the legacy format
+		m_readVersion = 0u;
+		m_isReadingCompact = _dataLength >= CompactFormatHeaderSize && memcmp(_data, CompactFormatMagic, sizeof(CompactFormatMagic)) == 0;
+		if (m_isReadingCompact)
+		{
+			// Data of a newer version is read as empty data, and fails the read
+			uint8_t version = m_readDataBuffer.data[sizeof(CompactFormatMagic)];
+			m_readDataBuffer.cursor = version <= CompactFormatVersion ? CompactFormatHeaderSize : _dataLength;
+			m_readVersion = version;
+			m_hasReadFailed = m_hasReadFailed || version > CompactFormatVersion;
+		}
+		m_readObjects.clear();
+		m_readObjectReferences.clear();
+		m_pathMemberIndices.clear();
+		m_pathElementPositions.clear();
+		m_readRecordsPosition = m_readDataBuffer.cursor;
+
+		m_isReading = true;
+	}
+
+	bool BinarySerializer::endRead()
+	{
+		assert(m_isReading);
+
+		m_readDataBuffer = FDataBuffer();
+		m_readNames.clear();
+		m_isReading = false;
+		return !m_hasReadFailed;
+	}
+
+	void BinarySerializer::beginIncrementalRead()
+	{
+		assert(!m_isReading);
+		assert(!m_isWriting);
+
+		m_readEntryIndex = EntryIndex();
+		m_readNames.clear();
+		m_readSchemas.clear();
+		++m_readSchemaGeneration;
+		if (m_viewAllocator)
+			m_viewAllocator->reset();
+
+		m_incrementalTargets.clear();
+		m_incrementalFrames.assign(1u, IncrementalFrame());
+		m_incrementalBuffer.clear();
+		m_incrementalPosition = 0u;
+		m_incrementalNeededSize = 0u;
+		m_hasIncrementalFailed = false;
+		m_incrementalCompression = IncrementalCompression_Unknown;
+		m_incrementalCompressor = nullptr;
+		m_incrementalCompressedBuffer.clear();
+		m_readObjects.clear();
+		m_readObjectReferences.clear();
+
+		m_isReadingCompact = true;
+		m_isReadingTransientData = true;
+		m_isReadingIncremental = true;
+		m_isReading = true;
+	}
+
+	bool BinarySerializer::feed(const void* _data, size_t _dataLength)
+	{
+		assert(m_isReadingIncremental);
+
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(_data);
+		if (m_incrementalCompression == IncrementalCompression_Unknown)
+		{
+			// Kept until the header tells whether the data is compressed
+			std::vector<uint8_t>& header = m_incrementalCompressedBuffer;
+			header.insert(header.end(), bytes, bytes + _dataLength);
+			if (header.size() < CompactFormatHeaderSize)
+				return true;
+
+			if (memcmp(header.data(), CompactFormatMagic, sizeof(CompactFormatMagic)) != 0 || (header[CompactFormatHeaderSize - 1u] & CompactFlag_Compressed) == 0u)
+			{
+				m_incrementalCompression = IncrementalCompression_None;
+				std::vector<uint8_t> pendingBytes;
+				pendingBytes.swap(header);
+				return _feedDecoded(pendingBytes.data(), pendingBytes.size());
+			}
+
+			if (header.size() < CompressedHeaderSize)
+				return true;
+			m_incrementalCompressor = FindCompressor(header[CompactFormatHeaderSize]);
+			m_incrementalCompression = IncrementalCompression_Blocks;
+			m_hasIncrementalFailed = m_incrementalCompressor == nullptr;
+			header.erase(header.begin(), header.begin() + CompressedHeaderSize);
+			_dataLength = 0u;
+		}
+
+		if (m_incrementalCompression == IncrementalCompression_Blocks)
+		{
+			_feedCompressed(bytes, _dataLength);
+			return !m_hasIncrementalFailed;
+		}
+		return _feedDecoded(bytes, _dataLength);
+	}
+
+	void BinarySerializer::_feedCompressed(const uint8_t* _data, size_t _dataLength)
+	{
+		std::vector<uint8_t>& blocks = m_incrementalCompressedBuffer;
+		blocks.insert(blocks.end(), _data, _data + _dataLength);
+
+		size_t cursor = 0u;
+		while (!m_hasIncrementalFailed)
+		{
+			size_t availableSize = blocks.size() - cursor;
+			size_t headerSize = 0u, size = 0u, storedSize = 0u;
+			if (!ReadCompressedBlockHeader(m_incrementalCompressor, blocks.data() + cursor, availableSize, headerSize, size, storedSize))
+			{
+				// Headers take two varints at most
+				m_hasIncrementalFailed = availableSize >= 20u;
+				break;
+			}
+			if (storedSize > availableSize - headerSize)
+				break;
+
+			m_incrementalBlock.resize(size);
+			if (!DecompressBlock(m_incrementalCompressor, blocks.data() + cursor + headerSize, storedSize, m_incrementalBlock.data(), size))
+			{
+				m_hasIncrementalFailed = true;
+				break;
+			}
+			cursor += headerSize + storedSize;
+			_feedDecoded(m_incrementalBlock.data(), size);
+		}
+		blocks.erase(blocks.begin(), blocks.begin() + cursor);
+	}
+
+	bool BinarySerializer::_feedDecoded(const uint8_t* _data, size_t _dataLength)
+	{
+		const uint8_t* bytes = _data;
+		while (_dataLength > 0u && !m_hasIncrementalFailed)
+		{
+			if (m_incrementalBuffer.empty())
+			{
+				// Decodes in place, and only keeps what could not be decoded
+				size_t decodedSize = _decodeIncremental(bytes, _dataLength);
+				m_incrementalPosition += decodedSize;
+				m_incrementalBuffer.assign(bytes + decodedSize, bytes + _dataLength);
+				break;
+			}
+
+			// Completes the pending bytes up to what the decoding waits for
+			size_t neededSize = std::max(m_incrementalNeededSize, m_incrementalBuffer.size() + 1u);
+			size_t appendedSize = std::min(_dataLength, neededSize - m_incrementalBuffer.size());
+			m_incrementalBuffer.insert(m_incrementalBuffer.end(), bytes, bytes + appendedSize);
+			bytes += appendedSize;
+			_dataLength -= appendedSize;
+			if (m_incrementalBuffer.size() < neededSize)
+				break;
+
+			size_t decodedSize = _decodeIncremental(m_incrementalBuffer.data(), m_incrementalBuffer.size());
+			m_incrementalPosition += decodedSize;
+			m_incrementalBuffer.erase(m_incrementalBuffer.begin(), m_incrementalBuffer.begin() + decodedSize);
+		}
+
+		return !m_hasIncrementalFailed;
+	}
+
+	bool BinarySerializer::endIncrementalRead()
+	{
+		assert(m_isReadingIncremental);
+
+		// Descriptions may have waited for more bytes than the data had left
+		while (!m_hasIncrementalFailed && !m_incrementalBuffer.empty())
+		{
+			size_t decodedSize = _decodeIncremental(m_incrementalBuffer.data(), m_incrementalBuffer.size());
+			if (decodedSize == 0u)
+				break;
+			m_incrementalPosition += decodedSize;
+			m_incrementalBuffer.erase(m_incrementalBuffer.begin(), m_incrementalBuffer.begin() + decodedSize);
+		}
+
+		bool isComplete = !m_hasIncrementalFailed && m_incrementalBuffer.empty() && m_incrementalCompressedBuffer.empty() && m_incrementalFrames.size() == 1u && m_incrementalPosition >= CompactFormatHeaderSize;
+		_endReadObjects();
+
+		m_incrementalTargets.clear();
+		m_incrementalFrames.clear();
+		m_incrementalBuffer = std::vector<uint8_t>();
+		m_incrementalCompressedBuffer = std::vector<uint8_t>();
+		m_incrementalBlock = std::vector<uint8_t>();
+		m_readNames.clear();
+		m_isReadingTransientData = false;
+		m_isReadingIncremental = false;
+		m_isReading = false;
+
+		return isComplete;
+	}
+
+	// Size of the payload of values whose serialization does not depend on the instance, 0 for the others
+	static size_t GetFixedPayloadSize(const TypeDesc* _typeDesc)
+	{
+		if (!_typeDesc)
+			return 0u;
+
+		Type type = _typeDesc->getType();
+		if (type >= Type_bool && type <= Type_double)
+			return _typeDesc->getSize();
+
+		if (type == Type_FixedSizeArray)
+		{
+			// Arrays of arithmetic values are written as their raw memory
+			const FixedSizeArrayTypeDesc* fixedSizeArrayTypeDesc = static_cast<const FixedSizeArrayTypeDesc*>(_typeDesc);
+			const TypeDesc* subType = fixedSizeArrayTypeDesc->getSubType();
+			size_t elementSize = GetFixedPayloadSize(subType);
+			if (elementSize > 0u && elementSize == subType->getSize())
+				return elementSize * fixedSizeArrayTypeDesc->getElementCount();
+		}
+		return 0u;
+	}
+
+	enum ArrayEncoding : uint8_t
+	{
+		ArrayEncoding_Elements = 0,
+		ArrayEncoding_Raw = 1, // Raw memory of classes, after the description of their values
+		ArrayEncoding_Values = 2, // Raw memory of arithmetic or enum values, after their kind
+		ArrayEncoding_Delta = 3, // Runs of elements that changed from a baseline, [varint gap + 1][varint length][elements], up to a 0 gap
+	};
+
+	// Owned pointers write a bool in version 1, non-owned pointers nothing
+	enum PointerTag : uint8_t
+	{
+		PointerTag_Null = 0,
+		PointerTag_Object = 1, // Class reference and payload
+		PointerTag_Reference = 2, // Ordinal of an object of the entry
+		PointerTag_IdentifiedObject = 3, // Ordinal, class reference and payload
+	};
+
+	enum PointerFlag : uint8_t
+	{
+		PointerFlag_OwnedPointer = 1u << 0, // Raw pointers with the OwnedPointer meta data, which may share their object
+		PointerFlag_Pointer = 1u << 1, // Raw pointers to objects owned elsewhere, possibly written after them
+		PointerFlag_View = 1u << 2, // std::string_view and std::span, read as views into the data
+		PointerFlag_AnyPointer = PointerFlag_OwnedPointer | PointerFlag_Pointer,
+	};
+
+	// Kinds of the values of raw blocks, written in the files. Enums are their integer kind with the enum bit set.
+	static const uint8_t RawKind_EnumBit = 0x80u;
+
+	static uint8_t GetArithmeticRawKind(Type _type)
+	{
+		switch (_type)
+		{
+		case Type_bool: return 1u;
+		case Type_char: return 2u;
+		case Type_int8: return 3u;
+		case Type_int16: return 4u;
+		case Type_int32: return 5u;
+		case Type_int64: return 6u;
+		case Type_uint8: return 7u;
+		case Type_uint16: return 8u;
+		case Type_uint32: return 9u;
+		case Type_uint64: return 10u;
+		case Type_float: return 11u;
+		case Type_double: return 12u;
+		default: return 0u;
+		}
+	}
+
+	static size_t GetRawKindSize(uint8_t _kind)
+	{
+		static const size_t s_sizes[] = { 0u, sizeof(bool), sizeof(char), 1u, 2u, 4u, 8u, 1u, 2u, 4u, 8u, sizeof(float), sizeof(double) };
+		uint8_t kind = _kind & ~RawKind_EnumBit;
+		return kind < sizeof(s_sizes) / sizeof(s_sizes[0]) ? s_sizes[kind] : 0u;
+	}
+
+	// Kind of arithmetic and enum types, 0 for the others
+	static uint8_t GetValueRawKind(const TypeDesc* _typeDesc)
+	{
+		if (_typeDesc->getType() == Type_Enum)
+		{
+			const TypeDesc* subType = static_cast<const Enum*>(_typeDesc)->getSubType();
+			return subType ? GetArithmeticRawKind(subType->getType()) | RawKind_EnumBit : 0u;
+		}
+		return GetArithmeticRawKind(_typeDesc->getType());
+	}
+
+	// Kinds of the members in the schemas: the kind of values, with the array bit for fixed size arrays of arithmetic values.
+	// The other types are their encoded type with the type bit, followed in the schemas by GetSchemaTypeHash (version 5, 0 before).
+	static const uint8_t SchemaKind_ArrayBit = 0x40u;
+	static const uint8_t SchemaKind_TypeBit = 0x20u;
+
+	// Types written the same way
+	static Type GetEncodedType(Type _type)
+	{
+		switch (_type)
+		{
+		case Type_std_string_view: return Type_std_string;
+		case Type_std_span: return Type_std_vector;
+		case Type_std_unordered_map: return Type_std_map;
+		default: return _type;
+		}
+	}
+
+	static uint8_t GetSchemaKind(const TypeDesc* _typeDesc)
+	{
+		if (!_typeDesc)
+			return 0u;
+
+		if (_typeDesc->getType() == Type_FixedSizeArray)
+		{
+			const TypeDesc* subType = static_cast<const FixedSizeArrayTypeDesc*>(_typeDesc)->getSubType();
+			uint8_t kind = subType ? GetArithmeticRawKind(subType->getType()) : 0u;
+			if (kind != 0u)
+				return kind | SchemaKind_ArrayBit;
+		}
+		uint8_t kind = GetValueRawKind(_typeDesc);
+		return kind != 0u ? kind : static_cast<uint8_t>(SchemaKind_TypeBit | GetEncodedType(_typeDesc->getType()));
+	}
+
+	// Encoded types of a value and of its sub types. Arithmetic sub types are not told apart, arrays of them being converted when read,
+	// nor are classes, whose members are read by id whatever the class.
+	static void AppendSchemaTypeSignature(const TypeDesc* _typeDesc, std::vector<uint8_t>& _outSignature)
+	{
+		if (!_typeDesc)
+		{
+			_outSignature.push_back(Type_none);
+			return;
+		}
+
+		uint8_t kind = GetValueRawKind(_typeDesc);
+		if (kind != 0u)
+		{
+			_outSignature.push_back((kind & RawKind_EnumBit) != 0u ? Type_Enum : Type_double);
+			return;
+		}
+
+		_outSignature.push_back(static_cast<uint8_t>(GetEncodedType(_typeDesc->getType())));
+		switch (_typeDesc->getType())
+		{
+		case Type_std_vector:
+			AppendSchemaTypeSignature(static_cast<const StdVectorTypeDesc*>(_typeDesc)->getSubType(), _outSignature);
+			break;
+		case Type_std_span:
+			AppendSchemaTypeSignature(static_cast<const StdSpanTypeDesc*>(_typeDesc)->getSubType(), _outSignature);
+			break;
+		case Type_std_optional:
+			AppendSchemaTypeSignature(static_cast<const StdOptionalTypeDesc*>(_typeDesc)->getSubType(), _outSignature);
+			break;
+		case Type_std_unique_ptr:
+			AppendSchemaTypeSignature(static_cast<const StdUniquePtrTypeDesc*>(_typeDesc)->getSubType(), _outSignature);
+			break;
+		case Type_Pointer:
+			AppendSchemaTypeSignature(static_cast<const PointerTypeDesc*>(_typeDesc)->getSubType(), _outSignature);
+			break;
+		case Type_FixedSizeArray:
+			AppendSchemaTypeSignature(static_cast<const FixedSizeArrayTypeDesc*>(_typeDesc)->getSubType(), _outSignature);
+			break;
+		case Type_std_pair:
+			AppendSchemaTypeSignature(static_cast<const StdPairTypeDesc*>(_typeDesc)->getFirstType(), _outSignature);
+			AppendSchemaTypeSignature(static_cast<const StdPairTypeDesc*>(_typeDesc)->getSecondType(), _outSignature);
+			break;
+		case Type_std_map:
+		case Type_std_unordered_map:
+			AppendSchemaTypeSignature(static_cast<const StdMapTypeDesc*>(_typeDesc)->getKeyType(), _outSignature);
+			AppendSchemaTypeSignature(static_cast<const StdMapTypeDesc*>(_typeDesc)->getValueType(), _outSignature);
+			break;
+		default:
+			break;
+		}
+	}
+
+	static uint32_t GetSchemaTypeHash(const TypeDesc* _typeDesc)
+	{
+		std::vector<uint8_t> signature;
+		AppendSchemaTypeSignature(_typeDesc, signature);
+		return Hash32(signature.data(), signature.size());
+	}
+
+	static bool IsArithmeticSchemaKind(uint8_t _kind)
+	{
+		return _kind != 0u && (_kind & (RawKind_EnumBit | SchemaKind_ArrayBit)) == 0u;
+	}
+
+	// Arithmetic value read as one kind, to be stored as another
+	struct ConvertedValue
+	{
+		bool isFloating = false;
+		bool isUnsigned = false;
+		int64_t integer = 0;
+		double floating = 0.0;
+	};
+
+	template <typename T>
+	static T LoadRawValue(const uint8_t* _bytes)
+	{
+		T value;
+		memcpy(&value, _bytes, sizeof(value));
+		return value;
+	}
+
+	// Floating point values out of the range of an integer type are clamped to it
+	template <typename T>
+	static void StoreConvertedValue(void* _destination, const ConvertedValue& _value)
+	{
+		T value;
+		if (std::is_same<T, bool>::value)
+		{
+			value = static_cast<T>(_value.isFloating ? _value.floating != 0.0 : _value.integer != 0);
+		}
+		else if (std::is_floating_point<T>::value)
+		{
+			double floating = _value.isFloating ? _value.floating : _value.isUnsigned ? static_cast<double>(static_cast<uint64_t>(_value.integer)) : static_cast<double>(_value.integer);
+			value = static_cast<T>(floating);
+		}
+		else if (_value.isFloating)
+		{
+			double floating = _value.floating;
+			if (!(floating == floating))
+				value = T();
+			else if (floating <= static_cast<double>(std::numeric_limits<T>::lowest()))
+				value = std::numeric_limits<T>::lowest();
+			else if (floating >= static_cast<double>(std::numeric_limits<T>::max()))
+				value = std::numeric_limits<T>::max();
+			else
+				value = static_cast<T>(floating);
+		}
+		else
+		{
+			value = static_cast<T>(_value.integer);
+		}
+		memcpy(_destination, &value, sizeof(value));
+	}
+
+	// Converts a value written with the arithmetic _sourceKind to the arithmetic _destinationKind, for members whose type changed
+	static bool ConvertRawValue(const uint8_t* _source, size_t _sourceSize, uint8_t _sourceKind, void* _destination, uint8_t _destinationKind)
+	{
+		if (_sourceSize != GetRawKindSize(_sourceKind))
+			return false;
+
+		ConvertedValue value;
+		switch (_sourceKind)
+		{
+		case 1u: value.integer = LoadRawValue<bool>(_source) ? 1 : 0; break;
+		case 2u: value.integer = LoadRawValue<char>(_source); break;
+		case 3u: value.integer = LoadRawValue<int8_t>(_source); break;
+		case 4u: value.integer = LoadRawValue<int16_t>(_source); break;
+		case 5u: value.integer = LoadRawValue<int32_t>(_source); break;
+		case 6u: value.integer = LoadRawValue<int64_t>(_source); break;
+		case 7u: value.integer = LoadRawValue<uint8_t>(_source); break;
+		case 8u: value.integer = LoadRawValue<uint16_t>(_source); break;
+		case 9u: value.integer = LoadRawValue<uint32_t>(_source); break;
+		case 10u: value.integer = static_cast<int64_t>(LoadRawValue<uint64_t>(_source)); value.isUnsigned = true; break;
+		case 11u: value.floating = LoadRawValue<float>(_source); value.isFloating = true; break;
+		case 12u: value.floating = LoadRawValue<double>(_source); value.isFloating = true; break;
+		default: return false;
+		}
+
+		switch (_destinationKind)
+		{
+		case 1u: StoreConvertedValue<bool>(_destination, value); break;
+		case 2u: StoreConvertedValue<char>(_destination, value); break;
+		case 3u: StoreConvertedValue<int8_t>(_destination, value); break;
+		case 4u: StoreConvertedValue<int16_t>(_destination, value); break;
+		case 5u: StoreConvertedValue<int32_t>(_destination, value); break;
+		case 6u: StoreConvertedValue<int64_t>(_destination, value); break;
+		case 7u: StoreConvertedValue<uint8_t>(_destination, value); break;
+		case 8u: StoreConvertedValue<uint16_t>(_destination, value); break;
+		case 9u: StoreConvertedValue<uint32_t>(_destination, value); break;
+		case 10u: StoreConvertedValue<uint64_t>(_destination, value); break;
+		case 11u: StoreConvertedValue<float>(_destination, value); break;
+		case 12u: StoreConvertedValue<double>(_destination, value); break;
+		default: return false;
+		}
+		return true;
+	}
+
+	bool BinarySerializer::_flattenRawFields(const TypeDesc* _typeDesc, std::string& _path, size_t _offset, RawLayout& _layout)
+	{
+		if (!_typeDesc)
+			return false;
+
+		RawLayout::Field field;
+		field.pathHash = HashCString(_path.c_str());
+		field.offset = _offset;
+		field.kind = GetValueRawKind(_typeDesc);
+		field.count = 1u;
+
+		switch (_typeDesc->getType())
+		{
+		case Type_FixedSizeArray:
+		{
+			const FixedSizeArrayTypeDesc* fixedSizeArrayTypeDesc = static_cast<const FixedSizeArrayTypeDesc*>(_typeDesc);
+			const TypeDesc* subType = fixedSizeArrayTypeDesc->getSubType();
+			if (!subType)
+				return false;
+
+			// Arrays of values are a single field, arrays of classes a field per element value
+			field.kind = GetValueRawKind(subType);
+			field.count = fixedSizeArrayTypeDesc->getElementCount();
+			if (field.kind != 0u)
+				break;
+
+			bool isRawCopyable = true;
+			size_t pathLength = _path.size();
+			for (size_t i = 0; i < fixedSizeArrayTypeDesc->getElementCount(); ++i)
+			{
+				_path += "[" + std::to_string(i) + "]";
+				isRawCopyable = _flattenRawFields(subType, _path, _offset + i * subType->getSize(), _layout) && isRawCopyable;
+				_path.resize(pathLength);
+			}
+			return isRawCopyable;
+		}
+		case Type_Class:
+		{
+			const Class* clss = static_cast<const Class*>(_typeDesc);
+			bool isRawCopyable = clss->isTriviallyCopyable() && !clss->hasFlags(TypeFlag_Polymorphic);
+
+			std::vector<ClassMember*> members;
+			clss->getMembers(members);
+			size_t pathLength = _path.size();
+			for (const ClassMember* member : members)
+			{
+				if (pathLength > 0u)
+					_path += '.';
+				_path += member->getName();
+				isRawCopyable = _flattenRawFields(member->getType(), _path, _offset + member->getOffset(), _layout) && isRawCopyable;
+				_path.resize(pathLength);
+			}
+			return isRawCopyable;
+		}
+		default:
+			break;
+		}
+
+		if (field.kind == 0u)
+			return false;
+
+		_layout.hasEnums = _layout.hasEnums || (field.kind & RawKind_EnumBit) != 0u;
+		_layout.fields.push_back(field);
+		return true;
+	}
+
+	const BinarySerializer::RawLayout* BinarySerializer::_getRawLayout(const TypeDesc* _typeDesc)
+	{
+		auto it = m_rawLayouts.find(_typeDesc);
+		if (it != m_rawLayouts.end())
+			return it->second;
+
+		if (m_isWritingInParallel)
+		{
+			std::lock_guard<std::mutex> lock(m_parallelMutex);
+			auto parallelIt = m_parallelRawLayouts.find(_typeDesc);
+			if (parallelIt != m_parallelRawLayouts.end())
+				return parallelIt->second;
+		}
+
+		RawLayout* layout = new RawLayout();
+		if (_typeDesc)
+		{
+			layout->elementSize = _typeDesc->getSize();
+			layout->elementAlignment = std::max<size_t>(_typeDesc->getAlignment(), 1u);
+
+			std::string path;
+			bool isFlat = _flattenRawFields(_typeDesc, path, 0u, *layout);
+			layout->isValue = GetValueRawKind(_typeDesc) != 0u;
+
+			size_t fieldsSize = 0u;
+			for (const RawLayout::Field& field : layout->fields)
+			{
+				fieldsSize += GetRawKindSize(field.kind) * field.count;
+			}
+			layout->isRawCopyable = isFlat && layout->elementSize > 0u && fieldsSize == layout->elementSize;
+
+			// Values are described by their kind. Classes by their size, field count, then hash, offset, kind and count of each field
+			std::vector<uint8_t>& bytes = layout->description;
+			if (layout->isValue)
+			{
+				bytes.push_back(layout->fields.front().kind);
+			}
+			else
+			{
+				uint8_t varint[10];
+				bytes.insert(bytes.end(), varint, varint + WriteVarint(varint, layout->elementSize));
+				bytes.insert(bytes.end(), varint, varint + WriteVarint(varint, layout->fields.size()));
+				for (const RawLayout::Field& field : layout->fields)
+				{
+					const uint8_t* pathHashBytes = reinterpret_cast<const uint8_t*>(&field.pathHash);
+					bytes.insert(bytes.end(), pathHashBytes, pathHashBytes + sizeof(field.pathHash));
+					bytes.insert(bytes.end(), varint, varint + WriteVarint(varint, field.offset));
+					bytes.push_back(field.kind);
+					bytes.insert(bytes.end(), varint, varint + WriteVarint(varint, field.count));
+				}
+			}
+		}
+
+		if (m_isWritingInParallel)
+		{
+			std::lock_guard<std::mutex> lock(m_parallelMutex);
+			auto result = m_parallelRawLayouts.insert(std::make_pair(_typeDesc, layout));
+			if (!result.second)
+				delete layout;
+			return result.first->second;
+		}
+
+		m_rawLayouts.insert(std::make_pair(_typeDesc, layout));
+		return layout;
+	}
+
+	bool BinarySerializer::_canWriteRaw(const RawLayout* _layout) const
+	{
+		return _layout->isRawCopyable && (!_layout->hasEnums || m_writeEnumsAsNumbers);
+	}
+
+	void BinarySerializer::_writeRawBlock(FDataBuffer* _dataBuffer, const RawLayout* _layout, const void* _data, size_t _count)
+	{
+		uint8_t encoding = _layout->isValue ? ArrayEncoding_Values : ArrayEncoding_Raw;
+		_dataBuffer->write(encoding);
+		_dataBuffer->write(_layout->description.data(), _layout->description.size());
+
+		// Aligns the values in the output, so that they can be viewed in place when the output is loaded at an aligned address
+		_dataBuffer->writePadding(_layout->elementAlignment);
+
+		_dataBuffer->write(_data, _count * _layout->elementSize);
+	}
+
+	bool BinarySerializer::_readRawBlock(FDataBuffer* _dataBuffer, uint8_t _encoding, size_t _count, RawBlock& _outBlock)
+	{
+		size_t descriptionPosition = _dataBuffer->cursor;
+		uint64_t elementSize = 0u;
+		if (_encoding == ArrayEncoding_Values)
+		{
+			uint8_t kind = 0u;
+			if (!_dataBuffer->read(kind))
+				return false;
+			elementSize = GetRawKindSize(kind);
+		}
+		else if (_encoding == ArrayEncoding_Raw)
+		{
+			uint64_t fieldCount = 0u;
+			if (!_dataBuffer->readVarint(elementSize) || !_dataBuffer->readVarint(fieldCount))
+				return false;
+
+			for (uint64_t i = 0; i < fieldCount; ++i)
+			{
+				uint32_t pathHash = 0u;
+				uint64_t offset = 0u;
+				uint8_t kind = 0u;
+				uint64_t count = 0u;
+				if (!_dataBuffer->read(pathHash) || !_dataBuffer->readVarint(offset) || !_dataBuffer->read(kind) || !_dataBuffer->readVarint(count))
+					return false;
+			}
+		}
+		else
+		{
+			return false;
+		}
+
+		_outBlock.encoding = _encoding;
+		_outBlock.description = _dataBuffer->data + descriptionPosition;
+		_outBlock.descriptionSize = _dataBuffer->cursor - descriptionPosition;
+
+		uint8_t padding = 0u;
+		if (!_dataBuffer->read(padding) || padding > _dataBuffer->dataLength - _dataBuffer->cursor)
+			return false;
+		_dataBuffer->cursor += padding;
+
+		if (elementSize == 0u || _count > (_dataBuffer->dataLength - _dataBuffer->cursor) / elementSize)
+			return false;
+
+		_outBlock.data = _dataBuffer->data + _dataBuffer->cursor;
+		_outBlock.elementSize = static_cast<size_t>(elementSize);
+		_dataBuffer->cursor += _count * _outBlock.elementSize;
+		return true;
+	}
+
+	void BinarySerializer::_copyRawBlock(const RawBlock& _block, const RawLayout* _layout, size_t _count, uint8_t* _destination)
+	{
+		if (_layout->isRawCopyable && _block.descriptionSize == _layout->description.size() && memcmp(_block.description, _layout->description.data(), _block.descriptionSize) == 0)
+		{
+			memcpy(_destination, _block.data, _count * _layout->elementSize);
+			return;
+		}
+
+		// Different layouts: values are copied to the fields with the same path and kind, and converted for arithmetic fields of another kind
+		struct FieldCopy
+		{
+			size_t sourceOffset;
+			size_t destinationOffset;
+			size_t size;
+			uint8_t sourceKind;
+			uint8_t destinationKind; // 0 when copied as is
+			size_t count;
+		};
+		std::vector<FieldCopy> fieldCopies;
+
+		// A value is a single field with an empty path
+		bool isValue = _block.encoding == ArrayEncoding_Values;
+		size_t cursor = 0u;
+		uint64_t elementSize = _block.elementSize;
+		uint64_t fieldCount = 1u;
+		if (!isValue)
+		{
+			ReadVarint(_block.description, _block.descriptionSize, cursor, elementSize);
+			ReadVarint(_block.description, _block.descriptionSize, cursor, fieldCount);
+		}
+		for (uint64_t i = 0; i < fieldCount; ++i)
+		{
+			RawLayout::Field field;
+			uint64_t offset = 0u;
+			uint64_t count = 1u;
+			if (isValue)
+			{
+				field.pathHash = HashCString("");
+				field.kind = _block.description[0];
+			}
+			else
+			{
+				memcpy(&field.pathHash, _block.description + cursor, sizeof(field.pathHash));
+				cursor += sizeof(field.pathHash);
+				ReadVarint(_block.description, _block.descriptionSize, cursor, offset);
+				field.kind = _block.description[cursor++];
+				ReadVarint(_block.description, _block.descriptionSize, cursor, count);
+			}
+
+			size_t kindSize = GetRawKindSize(field.kind);
+			if (kindSize == 0u || count > elementSize || offset + kindSize * count > elementSize)
+				continue;
+
+			for (const RawLayout::Field& destinationField : _layout->fields)
+			{
+				if (destinationField.pathHash != field.pathHash)
+					continue;
+
+				bool isConverted = destinationField.kind != field.kind;
+				if (!isConverted || (IsArithmeticSchemaKind(field.kind) && IsArithmeticSchemaKind(destinationField.kind)))
+				{
+					FieldCopy fieldCopy;
+					fieldCopy.sourceOffset = static_cast<size_t>(offset);
+					fieldCopy.destinationOffset = destinationField.offset;
+					fieldCopy.count = std::min(static_cast<size_t>(count), destinationField.count);
+					fieldCopy.size = kindSize * fieldCopy.count;
+					fieldCopy.sourceKind = field.kind;
+					fieldCopy.destinationKind = isConverted ? destinationField.kind : 0u;
+					fieldCopies.push_back(fieldCopy);
+				}
+				break;
+			}
+		}
+
+		for (size_t i = 0; i < _count; ++i)
+		{
+			const uint8_t* source = _block.data + i * _block.elementSize;
+			uint8_t* destination = _destination + i * _layout->elementSize;
+			for (const FieldCopy& fieldCopy : fieldCopies)
+			{
+				if (fieldCopy.destinationKind == 0u)
+				{
+					memcpy(destination + fieldCopy.destinationOffset, source + fieldCopy.sourceOffset, fieldCopy.size);
+					continue;
+				}
+
+				size_t sourceKindSize = GetRawKindSize(fieldCopy.sourceKind);
+				size_t destinationKindSize = GetRawKindSize(fieldCopy.destinationKind);
+				for (size_t j = 0; j < fieldCopy.count; ++j)
+				{
+					ConvertRawValue(source + fieldCopy.sourceOffset + j * sourceKindSize, sourceKindSize, fieldCopy.sourceKind, destination + fieldCopy.destinationOffset + j * destinationKindSize, fieldCopy.destinationKind);
+				}
+			}
+		}
+	}
+
+	const BinarySerializer::ClassPlan* BinarySerializer::_getClassPlan(const Class* _class)
+	{
+		auto it = m_classPlans.find(_class);
+		if (it != m_classPlans.end())
+			return it->second;
+
+		if (m_isWritingInParallel)
+		{
+			std::lock_guard<std::mutex> lock(m_parallelMutex);
+			auto parallelIt = m_parallelClassPlans.find(_class);
+			if (parallelIt != m_parallelClassPlans.end())
+				return parallelIt->second;
+		}
+
+		ClassPlan* plan = new ClassPlan();
+
+		std::vector<ClassMember*> members;
+		_class->getMembers(members);
+		plan->members.reserve(members.size());
+		for (const ClassMember* classMember : members)
+		{
+			ClassPlan::Member member;
+			member.id = classMember->getName();
+			member.idSize = strlen(member.id) + 1;
+			member.idHash = HashCString(member.id);
+			member.offset = classMember->getOffset();
+			member.type = classMember->getType();
+			member.metaDataSet = &classMember->GetMetaDataSet();
+			member.fixedSize = GetFixedPayloadSize(member.type);
+			plan->members.push_back(member);
+		}
+
+		// Member ids are written as hashes of their names, which must not collide, and so are the classes in the schemas
+		const TypeDesc* typeWithSameName = FindTypeByName(_class->getName());
+		plan->hasIdCollision = typeWithSameName && typeWithSameName != _class;
+		for (size_t i = 0; i < plan->members.size() && !plan->hasIdCollision; ++i)
+		{
+			for (size_t j = i + 1; j < plan->members.size(); ++j)
+			{
+				if (plan->members[i].idHash == plan->members[j].idHash)
+				{
+					plan->hasIdCollision = true;
+					break;
+				}
+			}
+		}
+
+		for (size_t i = 0; i < plan->members.size(); ++i)
+		{
+			const ClassPlan::Member& member = plan->members[i];
+			if (member.fixedSize == 0u || plan->runs.empty() || plan->runs.back().entriesTemplate.empty())
+			{
+				plan->runs.emplace_back();
+				plan->runs.back().firstMember = i;
+			}
+
+			ClassPlan::Run& run = plan->runs.back();
+			++run.memberCount;
+			if (member.fixedSize > 0u)
+			{
+				// Same layout as the one of variable size members: id hash, payload length, payload
+				std::vector<uint8_t>& bytes = run.entriesTemplate;
+				const uint8_t* idHashBytes = reinterpret_cast<const uint8_t*>(&member.idHash);
+				bytes.insert(bytes.end(), idHashBytes, idHashBytes + sizeof(member.idHash));
+				size_t lengthPosition = bytes.size();
+				bytes.resize(lengthPosition + GetVarintSize(member.fixedSize));
+				WriteVarint(bytes.data() + lengthPosition, member.fixedSize);
+				run.payloadOffsets.push_back(bytes.size());
+				bytes.resize(bytes.size() + member.fixedSize);
+			}
+		}
+
+		// Schema of the members, in the order they are written
+		plan->classNameHash = HashCString(_class->getName());
+		uint8_t varint[10];
+		for (const ClassPlan::Member& member : plan->members)
+		{
+			const uint8_t* idHashBytes = reinterpret_cast<const uint8_t*>(&member.idHash);
+			plan->schema.insert(plan->schema.end(), idHashBytes, idHashBytes + sizeof(member.idHash));
+			uint8_t kind = GetSchemaKind(member.type);
+			plan->schema.push_back(kind);
+			plan->schema.insert(plan->schema.end(), varint, varint + WriteVarint(varint, member.fixedSize));
+			if ((kind & SchemaKind_TypeBit) != 0u)
+			{
+				uint32_t typeHash = GetSchemaTypeHash(member.type);
+				const uint8_t* typeHashBytes = reinterpret_cast<const uint8_t*>(&typeHash);
+				plan->schema.insert(plan->schema.end(), typeHashBytes, typeHashBytes + sizeof(typeHash));
+			}
+		}
+		plan->fingerprint = Hash32(plan->schema.data(), plan->schema.size());
+
+		if (m_isWritingInParallel)
+		{
+			std::lock_guard<std::mutex> lock(m_parallelMutex);
+			auto result = m_parallelClassPlans.insert(std::make_pair(_class, plan));
+			if (!result.second)
+				delete plan;
+			return result.first->second;
+		}
+
+		m_classPlans.insert(std::make_pair(_class, plan));
+		return plan;
+	}
+
+	void BinarySerializer::_serializeEntry(FDataBuffer* _dataBuffer, const char* _id, void* _object, const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet)
+	{
+		assert(_dataBuffer);
+		assert(_id);
+		assert(_object);
+		assert(_typeDesc);
+
+		// Only top level entries are serialized from here, class members are serialized by _serialize and _readMembers
+		if (_hasIdCollision(_typeDesc))
+		{
+			m_hasIncrementalFailed = m_hasIncrementalFailed || m_isReadingIncremental;
+			m_hasWriteFailed = m_hasWriteFailed || m_isWriting;
+			m_hasReadFailed = m_hasReadFailed || m_isReading;
+		}
+		else if (m_isReadingIncremental)
+		{
+			// Read as its record is fed
+			IncrementalTarget target;
+			target.idHash = HashCString(_id);
+			target.object = _object;
+			target.typeDesc = _typeDesc;
+			target.metaDataSet = _metaDataSet;
+			m_incrementalTargets.push_back(target);
+		}
+		else if (m_isWriting && m_writeThreadCount > 1u && !_dataBuffer->stream)
+		{
+			ParallelEntry entry;
+			entry.idHash = HashCString(_id);
+			entry.object = _object;
+			entry.typeDesc = _typeDesc;
+			entry.metaDataSet = _metaDataSet;
+			entry.firstName = 0u;
+			entry.nameCount = 0u;
+			m_parallelEntries.push_back(entry);
+		}
+		else if (m_isWriting)
+		{
+			_writeNames(_getReachableNames(_typeDesc));
+			_writeSchemas(_getReachableClasses(_typeDesc));
+
+			uint32_t idHash = HashCString(_id);
+			_beginWriteObjects(_object, _typeDesc, _metaDataSet);
+			if (_dataBuffer->stream)
+				_measureEntryRecord(_dataBuffer, idHash, _object, _typeDesc, _metaDataSet);
+
+			uint8_t record = CompactRecord_Entry;
+			_dataBuffer->write(record);
+			_dataBuffer->write(idHash);
+			size_t lengthPosition = _dataBuffer->reserveLength();
+			_serialize(_dataBuffer, _object, _typeDesc, _metaDataSet);
+			_dataBuffer->patchLength(lengthPosition);
+			_endWriteObjects();
+
+			if (_dataBuffer->stream)
+				_dataBuffer->stream->knownLengths.clear();
+			else if (_dataBuffer->cursor >= m_writeSegmentSize)
+				_dataBuffer->seal();
+		}
+		else if (m_isReading)
+		{
+			assert(_dataBuffer == &m_readDataBuffer);
+
+			uint8_t* payload = nullptr;
+			size_t payloadSize = 0u;
+			bool isFound = m_isReadingCompact
+				? _findRootEntry(_id, HashCString(_id), payload, payloadSize)
+				: _findEntry(_dataBuffer, m_readEntryIndex, _id, strlen(_id) + 1, 0u, payload, payloadSize);
+			m_hasReadEntry = isFound;
+			if (isFound)
+			{
+				FDataBuffer entryDataBuffer(payload, payloadSize);
+				_serialize(&entryDataBuffer, _object, _typeDesc, _metaDataSet);
+				_endReadObjects();
+			}
+		}
+	}
+
+	void BinarySerializer::_serializeDeltaEntry(const char* _id, void* _object, const void* _baseline, const TypeDesc* _typeDesc)
+	{
+		assert(m_isWriting);
+		FDataBuffer* dataBuffer = m_writeDataBuffer;
+
+		// What did not change is dropped after being written, which streamed bytes may already be past
+		if (dataBuffer->stream || _hasIdCollision(_typeDesc))
+		{
+			_serializeEntry(dataBuffer, _id, _object, _typeDesc);
+			return;
+		}
+
+		// Entries given before are written first, so that the output is the same with several threads
+		if (!m_parallelEntries.empty())
+			_writeParallelEntries();
+
+		_writeNames(_getReachableNames(_typeDesc));
+		_writeSchemas(_getReachableClasses(_typeDesc));
+
+		size_t recordPosition = dataBuffer->cursor;
+		uint8_t record = CompactRecord_Entry;
+		dataBuffer->write(record);
+		dataBuffer->write(HashCString(_id));
+		size_t lengthPosition = dataBuffer->reserveLength();
+		_beginWriteObjects(_object, _typeDesc, nullptr);
+		if (_writeDelta(dataBuffer, _object, _baseline, _typeDesc, nullptr))
+			dataBuffer->patchLength(lengthPosition);
+		else
+			dataBuffer->cursor = dataBuffer->dataLength = recordPosition;
+		_endWriteObjects();
+
+		if (dataBuffer->cursor >= m_writeSegmentSize)
+			dataBuffer->seal();
+	}
+
+	bool BinarySerializer::_writeDelta(FDataBuffer* _dataBuffer, void* _object, const void* _baseline, const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet)
+	{
+		// Values of fixed size are compared in memory
+		size_t fixedPayloadSize = GetFixedPayloadSize(_typeDesc);
+		if (fixedPayloadSize > 0u)
+		{
+			if (memcmp(_object, _baseline, fixedPayloadSize) == 0)
+				return false;
+			_serialize(_dataBuffer, _object, _typeDesc, _metaDataSet);
+			return true;
+		}
+
+		// Pointers refer to the objects of the entry, they cannot be compared with the ones of the baseline
+		bool hasPointers = (_getPointerFlags(_typeDesc, _metaDataSet) & PointerFlag_AnyPointer) != 0u;
+		if (_typeDesc->getType() == Type_Class)
+		{
+			// Members that did not change are left out
+			const ClassPlan* plan = _getClassPlan(static_cast<const Class*>(_typeDesc));
+			uint8_t* instance = reinterpret_cast<uint8_t*>(_object);
+			const uint8_t* baselineInstance = reinterpret_cast<const uint8_t*>(_baseline);
+			bool isChanged = false;
+			size_t lengthPosition = _dataBuffer->reserveLength();
+			for (const ClassPlan::Member& member : plan->members)
+			{
+				if (member.fixedSize > 0u)
+				{
+					if (memcmp(instance + member.offset, baselineInstance + member.offset, member.fixedSize) == 0)
+						continue;
+					_dataBuffer->write(member.idHash);
+					_dataBuffer->writeVarint(member.fixedSize);
+					_serialize(_dataBuffer, instance + member.offset, member.type, member.metaDataSet);
+					isChanged = true;
+					continue;
+				}
+
+				size_t memberPosition = _dataBuffer->cursor;
+				_dataBuffer->write(member.idHash);
+				size_t memberLengthPosition = _dataBuffer->reserveLength();
+				if (_writeDelta(_dataBuffer, instance + member.offset, baselineInstance + member.offset, member.type, member.metaDataSet))
+				{
+					_dataBuffer->patchLength(memberLengthPosition);
+					isChanged = true;
+				}
+				else
+				{
+					_dataBuffer->cursor = _dataBuffer->dataLength = memberPosition;
+				}
+			}
+			_dataBuffer->patchLength(lengthPosition);
+			return isChanged;
+		}
+		else if (_typeDesc->getType() == Type_std_vector && !hasPointers)
+		{
+			const StdVectorTypeDesc* vectorTypeDesc = static_cast<const StdVectorTypeDesc*>(_typeDesc);
+			const TypeDesc* subType = vectorTypeDesc->getSubType();
+			StdVectorTypeDesc::Span span = vectorTypeDesc->instanceGetSpan(_object);
+			StdVectorTypeDesc::Span baselineSpan = vectorTypeDesc->instanceGetSpan(const_cast<void*>(_baseline));
+			size_t vectorPosition = _dataBuffer->cursor;
+			_dataBuffer->writeVarint(span.size);
+			if (span.size == 0u)
+				return baselineSpan.size != 0u;
+
+			uint8_t encoding = ArrayEncoding_Delta;
+			_dataBuffer->write(encoding);
+
+			// Elements of raw copyable types are compared in memory, the others from what they write
+			const RawLayout* rawLayout = _getRawLayout(subType);
+			bool isChanged = span.size != baselineSpan.size;
+			size_t nextIndex = 0u;
+			size_t runLengthPosition = SIZE_MAX;
+			for (size_t i = 0; i < span.size; ++i)
+			{
+				bool hasBaseline = i < baselineSpan.size;
+				if (hasBaseline && rawLayout->isRawCopyable && memcmp(span.at(i), baselineSpan.at(i), rawLayout->elementSize) == 0)
+				{
+					if (runLengthPosition != SIZE_MAX)
+						_dataBuffer->patchLength(runLengthPosition);
+					runLengthPosition = SIZE_MAX;
+					continue;
+				}
+
+				size_t elementPosition = _dataBuffer->cursor;
+				bool isRunOpened = runLengthPosition == SIZE_MAX;
+				if (isRunOpened)
+				{
+					_dataBuffer->writeVarint(i - nextIndex + 1u);
+					runLengthPosition = _dataBuffer->reserveLength();
+				}
+
+				if (!hasBaseline || rawLayout->isRawCopyable)
+				{
+					_serialize(_dataBuffer, span.at(i), subType);
+				}
+				else if (!_writeDelta(_dataBuffer, span.at(i), baselineSpan.at(i), subType, nullptr))
+				{
+					_dataBuffer->cursor = _dataBuffer->dataLength = elementPosition;
+					if (!isRunOpened)
+						_dataBuffer->patchLength(runLengthPosition);
+					runLengthPosition = SIZE_MAX;
+					continue;
+				}
+				nextIndex = i + 1u;
+				isChanged = true;
+			}
+			if (runLengthPosition != SIZE_MAX)
+				_dataBuffer->patchLength(runLengthPosition);
+			_dataBuffer->writeVarint(0u);
+
+			// Mostly changed vectors are smaller as a raw block
+			if (rawLayout->isRawCopyable && _dataBuffer->cursor - vectorPosition > span.size * rawLayout->elementSize)
+			{
+				_dataBuffer->cursor = _dataBuffer->dataLength = vectorPosition;
+				_serialize(_dataBuffer, _object, _typeDesc, _metaDataSet);
+			}
+			return isChanged;
+		}
+
+		// Other values are written whole, and compared with the baseline written at the same alignment
+		size_t position = _dataBuffer->cursor;
+		size_t alignmentPosition = _dataBuffer->getAlignmentPosition();
+		_serialize(_dataBuffer, _object, _typeDesc, _metaDataSet);
+		if (hasPointers)
+			return true;
+
+		m_deltaDataBuffer.cursor = m_deltaDataBuffer.dataLength = 0u;
+		m_deltaDataBuffer.baseOffset = alignmentPosition;
+		_serialize(&m_deltaDataBuffer, const_cast<void*>(_baseline), _typeDesc, _metaDataSet);
+		size_t size = _dataBuffer->cursor - position;
+		return m_deltaDataBuffer.cursor != size || memcmp(m_deltaDataBuffer.data, _dataBuffer->data + position, size) != 0;
+	}
+
+	bool BinarySerializer::_readBaselineEntry(const char* _id, void* _object, const TypeDesc* _typeDesc)
+	{
+		uint8_t* payload = nullptr;
+		size_t payloadSize = 0u;
+		if (!m_isReadingCompact || !_findRootEntry(_id, HashCString(_id), payload, payloadSize))
+			return false;
+
+		FDataBuffer entryDataBuffer(payload, payloadSize);
+		_serialize(&entryDataBuffer, _object, _typeDesc);
+		_endReadObjects();
+		return true;
+	}
+
+	size_t BinarySerializer::_getSerializedSize(const char* _id, void* _object, const TypeDesc* _typeDesc)
+	{
+		assert(!m_isReading);
+		assert(!m_isWritingObjects);
+
+		// Outside of a write, counted as the only entry of an output
+		bool isWriting = m_isWriting;
+		FDataBuffer* writeDataBuffer = m_writeDataBuffer;
+		size_t position = CompactFormatHeaderSize;
+		if (isWriting)
+		{
+			if (!m_parallelEntries.empty())
+				_writeParallelEntries();
+			position = writeDataBuffer->getAlignmentPosition();
+		}
+		else
+		{
+			m_writeNameIndices.clear();
+			m_writeNames.clear();
+			m_writeSchemaClasses.clear();
+		}
+		m_isWriting = true;
+
+		FLengthStream countingStream;
+		countingStream.isCounting = true;
+		countingStream.chunkSize = SIZE_MAX;
+		m_measureDataBuffer.stream = &countingStream;
+		m_measureDataBuffer.baseOffset = position;
+		m_measureDataBuffer.cursor = 0u;
+		m_measureDataBuffer.dataLength = 0u;
+
+		// Names and schemas not written yet, which are forgotten once counted
+		size_t nameCount = m_writeNames.size();
+		std::vector<const Class*> newClasses;
+		for (const Class* clss : _getReachableClasses(_typeDesc))
+		{
+			if (m_writeSchemaClasses.count(clss) == 0u)
+				newClasses.push_back(clss);
+		}
+		m_writeDataBuffer = &m_measureDataBuffer;
+		_writeNames(_getReachableNames(_typeDesc));
+		_writeSchemas(newClasses);
+		m_writeDataBuffer = writeDataBuffer;
+		size_t recordsSize = m_measureDataBuffer.cursor;
+
+		// The object table is counted first when there are raw pointers, with the same buffer
+		_beginWriteObjects(_object, _typeDesc, nullptr);
+		countingStream = FLengthStream();
+		countingStream.isCounting = true;
+		countingStream.chunkSize = SIZE_MAX;
+		m_measureDataBuffer.stream = &countingStream;
+		m_measureDataBuffer.baseOffset = position + recordsSize;
+		m_measureDataBuffer.cursor = 0u;
+		m_measureDataBuffer.dataLength = 0u;
+
+		uint8_t record = CompactRecord_Entry;
+		m_measureDataBuffer.write(record);
+		m_measureDataBuffer.write(HashCString(_id));
+		size_t lengthPosition = m_measureDataBuffer.reserveLength();
+		_serialize(&m_measureDataBuffer, _object, _typeDesc);
+		m_measureDataBuffer.patchLength(lengthPosition);
+		_endWriteObjects();
+		size_t entrySize = m_measureDataBuffer.cursor;
+		m_measureDataBuffer.stream = nullptr;
+
+		// Forgotten after the entry, which refers to them
+		m_writeNames.resize(nameCount);
+		for (auto it = m_writeNameIndices.begin(); it != m_writeNameIndices.end();)
+		{
+			it = it->second >= nameCount ? m_writeNameIndices.erase(it) : std::next(it);
+		}
+		for (const Class* clss : newClasses)
+		{
+			m_writeSchemaClasses.erase(clss);
+		}
+
+		m_isWriting = isWriting;
+		return (isWriting ? 0u : CompactFormatHeaderSize) + recordsSize + entrySize;
+	}
+
+	void BinarySerializer::reserveWriteData(size_t _size)
+	{
+		assert(m_isWriting);
+
+		if (!m_writeDataBuffer->stream)
+			m_writeDataBuffer->reserve(m_writeDataBuffer->cursor + _size);
+	}
+
+	void BinarySerializer::_measureEntryRecord(FDataBuffer* _dataBuffer, uint32_t _idHash, void* _object, const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet)
+	{
+		FLengthStream* stream = _dataBuffer->stream;
+		assert(stream && stream->openSlots.empty());
+
+		// Starts at the same position, so that raw values get the same padding
+		m_measureStream.isCounting = true;
+		m_measureStream.sink = stream->sink;
+		m_measureStream.hasSinkFailed = stream->hasSinkFailed;
+		m_measureStream.chunkSize = stream->chunkSize;
+		m_measureStream.ordinal = 0u;
+		m_measureStream.knownLengths.clear();
+		m_measureStream.nextKnownLength = 0u;
+		m_measureDataBuffer.baseOffset = _dataBuffer->baseOffset + _dataBuffer->cursor;
+		m_measureDataBuffer.cursor = 0u;
+		m_measureDataBuffer.dataLength = 0u;
+		m_measureDataBuffer.stream = &m_measureStream;
+
+		uint8_t record = CompactRecord_Entry;
+		m_measureDataBuffer.write(record);
+		m_measureDataBuffer.write(_idHash);
+		size_t lengthPosition = m_measureDataBuffer.reserveLength();
+		_serialize(&m_measureDataBuffer, _object, _typeDesc, _metaDataSet);
+		m_measureDataBuffer.patchLength(lengthPosition);
+
+		// Measured when closed, looked up when opened
+		std::sort(m_measureStream.knownLengths.begin(), m_measureStream.knownLengths.end());
+		stream->knownLengths.swap(m_measureStream.knownLengths);
+		stream->nextKnownLength = 0u;
+		stream->ordinal = 0u;
+		// The lengths of a measure cut short are wrong, and the writes would fail anyway
+		if (m_measureStream.hasSinkFailed)
+			stream->hasSinkFailed = true;
+		// The objects keep their ordinals, and are written again
+		m_writeObjectCount = 0u;
+	}
+
+	// Parts are measured for every position modulo this, enough for the alignment of the raw values
+	static const size_t ParallelResidueCount = 64u;
+	static const size_t ParallelMinChunkElementCount = 256u;
+
+	void BinarySerializer::_writeParallelEntries()
+	{
+		if (!m_threadPool)
+			m_threadPool = new ThreadPool(m_writeThreadCount);
+		while (m_parallelWorkers.size() < m_threadPool->getThreadCount())
+		{
+			m_parallelWorkers.push_back(new ParallelWorker());
+		}
+
+		// Names are added in the order of the entries, each part only referring to the names added up to its entry
+		std::unordered_set<const TypeDesc*> visitedTypes;
+		m_parallelParts.clear();
+		for (ParallelEntry& entry : m_parallelEntries)
+		{
+			entry.firstName = _addNames(_getReachableNames(entry.typeDesc));
+			entry.nameCount = m_writeNames.size() - entry.firstName;
+			_prepareTypes(entry.typeDesc, visitedTypes);
+			if ((_getPointerFlags(entry.typeDesc, entry.metaDataSet) & PointerFlag_AnyPointer) == 0u)
+				_splitParallelValue(nullptr, entry.object, entry.typeDesc, entry.metaDataSet, m_writeNames.size());
+		}
+
+		// Measures the parts for every alignment they may start at
+		m_isWritingInParallel = true;
+		bool hasResidueFailed = false;
+		m_threadPool->parallelFor(m_parallelParts.size(), [this, &hasResidueFailed](size_t _index, size_t _threadIndex)
+		{
+			ParallelPart& part = m_parallelParts[_index];
+			ParallelWorker* worker = m_parallelWorkers[_threadIndex];
+			FLengthStream& stream = worker->measureStream;
+			stream.isCounting = true;
+			stream.chunkSize = SIZE_MAX;
+			stream.residueCount = ParallelResidueCount;
+			stream.residuePaddings.assign(ParallelResidueCount, 0u);
+			stream.maxResiduePadding = 0u;
+
+			FDataBuffer& dataBuffer = worker->dataBuffer;
+			dataBuffer.baseOffset = 0u;
+			dataBuffer.cursor = 0u;
+			dataBuffer.dataLength = 0u;
+			dataBuffer.stream = &stream;
+			dataBuffer.visibleNameCount = part.visibleNameCount;
+			_writeParallelPart(&dataBuffer, part);
+			dataBuffer.stream = nullptr;
+
+			part.residueSizes.resize(ParallelResidueCount);
+			for (size_t residue = 0; residue < ParallelResidueCount; ++residue)
+			{
+				part.residueSizes[residue] = dataBuffer.cursor + stream.residuePaddings[residue];
+			}
+			if (stream.hasResidueFailed)
+			{
+				std::lock_guard<std::mutex> lock(m_parallelMutex);
+				hasResidueFailed = true;
+			}
+			stream.hasResidueFailed = false;
+		});
+		m_isWritingInParallel = false;
+
+		if (hasResidueFailed)
+		{
+			// Sizes that the measures cannot tell, written by a single thread
+			m_writeNames.resize(m_parallelEntries.empty() ? m_writeNames.size() : m_parallelEntries.front().firstName);
+			for (auto it = m_writeNameIndices.begin(); it != m_writeNameIndices.end();)
+			{
+				it = it->second >= m_writeNames.size() ? m_writeNameIndices.erase(it) : std::next(it);
+			}
+			for (const ParallelEntry& entry : m_parallelEntries)
+			{
+				_writeNames(_getReachableNames(entry.typeDesc));
+				_writeSchemas(_getReachableClasses(entry.typeDesc));
+				uint8_t record = CompactRecord_Entry;
+				m_writeDataBuffer->write(record);
+				m_writeDataBuffer->write(entry.idHash);
+				size_t lengthPosition = m_writeDataBuffer->reserveLength();
+				_beginWriteObjects(entry.object, entry.typeDesc, entry.metaDataSet);
+				_serialize(m_writeDataBuffer, entry.object, entry.typeDesc, entry.metaDataSet);
+				_endWriteObjects();
+				m_writeDataBuffer->patchLength(lengthPosition);
+			}
+			m_parallelEntries.clear();
+			m_parallelParts.clear();
+			return;
+		}
+
+		// Writes everything but the parts, leaving room for them
+		m_parallelPartIndex = 0u;
+		m_parallelShifts.clear();
+		for (const ParallelEntry& entry : m_parallelEntries)
+		{
+			_writeNamesRecord(entry.firstName, entry.nameCount);
+			_writeSchemas(_getReachableClasses(entry.typeDesc));
+
+			uint8_t record = CompactRecord_Entry;
+			m_writeDataBuffer->write(record);
+			m_writeDataBuffer->write(entry.idHash);
+			size_t lengthPosition = m_writeDataBuffer->reserveLength();
+			if ((_getPointerFlags(entry.typeDesc, entry.metaDataSet) & PointerFlag_AnyPointer) != 0u)
+			{
+				// Pointers are linked through the object table of the entry, which is written by this thread
+				m_writeDataBuffer->visibleNameCount = entry.firstName + entry.nameCount;
+				_beginWriteObjects(entry.object, entry.typeDesc, entry.metaDataSet);
+				_serialize(m_writeDataBuffer, entry.object, entry.typeDesc, entry.metaDataSet);
+				_endWriteObjects();
+				m_writeDataBuffer->visibleNameCount = SIZE_MAX;
+			}
+			else
+			{
+				_splitParallelValue(m_writeDataBuffer, entry.object, entry.typeDesc, entry.metaDataSet, entry.firstName + entry.nameCount);
+			}
+			size_t shift = m_writeDataBuffer->patchLength(lengthPosition);
+			if (shift > 0u)
+				m_parallelShifts.push_back({ lengthPosition - m_writeDataBuffer->baseOffset, shift, m_parallelPartIndex });
+		}
+		assert(m_parallelPartIndex == m_parallelParts.size());
+
+		for (const ParallelShift& shift : m_parallelShifts)
+		{
+			for (size_t i = 0; i < shift.partCount; ++i)
+			{
+				if (m_parallelParts[i].position > shift.lengthPosition)
+					m_parallelParts[i].position += shift.shift;
+			}
+		}
+
+		// Serializes the parts at their place
+		m_isWritingInParallel = true;
+		m_threadPool->parallelFor(m_parallelParts.size(), [this](size_t _index, size_t _threadIndex)
+		{
+			const ParallelPart& part = m_parallelParts[_index];
+			FDataBuffer& dataBuffer = m_parallelWorkers[_threadIndex]->dataBuffer;
+			dataBuffer.baseOffset = part.alignmentPosition;
+			dataBuffer.cursor = 0u;
+			dataBuffer.dataLength = 0u;
+			dataBuffer.visibleNameCount = part.visibleNameCount;
+			_writeParallelPart(&dataBuffer, part);
+
+			assert(dataBuffer.dataLength == part.size);
+			memcpy(m_writeDataBuffer->data + part.position, dataBuffer.data, part.size);
+		});
+		m_isWritingInParallel = false;
+
+		for (auto& pair : m_parallelClassPlans)
+		{
+			m_classPlans.insert(pair);
+		}
+		m_parallelClassPlans.clear();
+		for (auto& pair : m_parallelRawLayouts)
+		{
+			m_rawLayouts.insert(pair);
+		}
+		m_parallelRawLayouts.clear();
+
+		m_parallelEntries.clear();
+		m_parallelParts.clear();
+	}
+
+	void BinarySerializer::_prepareTypes(const TypeDesc* _typeDesc, std::unordered_set<const TypeDesc*>& _visitedTypes)
+	{
+		if (!_typeDesc || !_visitedTypes.insert(_typeDesc).second)
+			return;
+
+		_getRawLayout(_typeDesc);
+		switch (_typeDesc->getType())
+		{
+		case Type_Class:
+		{
+			const Class* clss = static_cast<const Class*>(_typeDesc);
+			for (const ClassPlan::Member& member : _getClassPlan(clss)->members)
+			{
+				_prepareTypes(member.type, _visitedTypes);
+			}
+			for (const Class* child : clss->getChildren())
+			{
+				_prepareTypes(child, _visitedTypes);
+			}
+		}
+		break;
+		case Type_Pointer:
+			_prepareTypes(static_cast<const PointerTypeDesc*>(_typeDesc)->getSubType(), _visitedTypes);
+			break;
+		case Type_std_unique_ptr:
+			_prepareTypes(static_cast<const StdUniquePtrTypeDesc*>(_typeDesc)->getSubType(), _visitedTypes);
+			break;
+		case Type_std_vector:
+			_prepareTypes(static_cast<const StdVectorTypeDesc*>(_typeDesc)->getSubType(), _visitedTypes);
+			break;
+		case Type_std_span:
+			_prepareTypes(static_cast<const StdSpanTypeDesc*>(_typeDesc)->getSubType(), _visitedTypes);
+			break;
+		case Type_std_optional:
+			_prepareTypes(static_cast<const StdOptionalTypeDesc*>(_typeDesc)->getSubType(), _visitedTypes);
+			break;
+		case Type_FixedSizeArray:
+			_prepareTypes(static_cast<const FixedSizeArrayTypeDesc*>(_typeDesc)->getSubType(), _visitedTypes);
+			break;
+		case Type_std_pair:
+			_prepareTypes(static_cast<const StdPairTypeDesc*>(_typeDesc)->getFirstType(), _visitedTypes);
+			_prepareTypes(static_cast<const StdPairTypeDesc*>(_typeDesc)->getSecondType(), _visitedTypes);
+			break;
+		case Type_std_map:
+		case Type_std_unordered_map:
+			_prepareTypes(static_cast<const StdMapTypeDesc*>(_typeDesc)->getKeyType(), _visitedTypes);
+			_prepareTypes(static_cast<const StdMapTypeDesc*>(_typeDesc)->getValueType(), _visitedTypes);
+			break;
+		default:
+			break;
+		}
+	}
+
+	bool BinarySerializer::_isParallelSplit(void* _object, const TypeDesc* _typeDesc)
+	{
+		switch (_typeDesc->getType())
+		{
+		case Type_Class:
+		{
+			const ClassPlan* plan = _getClassPlan(static_cast<const Class*>(_typeDesc));
+			for (const ClassPlan::Member& member : plan->members)
+			{
+				if (member.fixedSize == 0u && _isParallelSplit(reinterpret_cast<uint8_t*>(_object) + member.offset, member.type))
+					return true;
+			}
+			return false;
+		}
+		case Type_std_vector:
+		{
+			// Vectors copied as raw memory are cheap enough to be written at once
+			const StdVectorTypeDesc* vectorTypeDesc = static_cast<const StdVectorTypeDesc*>(_typeDesc);
+			return vectorTypeDesc->instanceGetSpan(_object).size >= 2u * ParallelMinChunkElementCount && !_canWriteRaw(_getRawLayout(vectorTypeDesc->getSubType()));
+		}
+		default:
+			return false;
+		}
+	}
+
+	void BinarySerializer::_splitParallelValue(FDataBuffer* _dataBuffer, void* _object, const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet, size_t _visibleNameCount)
+	{
+		if (!_isParallelSplit(_object, _typeDesc))
+		{
+			_addParallelPart(_dataBuffer, _object, _typeDesc, _metaDataSet, 0u, 0u, _visibleNameCount);
+			return;
+		}
+
+		if (_typeDesc->getType() == Type_Class)
+		{
+			// As _serialize, the members of variable size being split further
+			const ClassPlan* plan = _getClassPlan(static_cast<const Class*>(_typeDesc));
+			uint8_t* instance = reinterpret_cast<uint8_t*>(_object);
+			size_t lengthPosition = _dataBuffer ? _dataBuffer->reserveLength() : 0u;
+			for (const ClassPlan::Run& run : plan->runs)
+			{
+				if (run.entriesTemplate.empty())
+				{
+					const ClassPlan::Member& member = plan->members[run.firstMember];
+					if (!_dataBuffer)
+					{
+						_splitParallelValue(nullptr, instance + member.offset, member.type, member.metaDataSet, _visibleNameCount);
+						continue;
+					}
+
+					_dataBuffer->write(member.idHash);
+					size_t memberLengthPosition = _dataBuffer->reserveLength();
+					_splitParallelValue(_dataBuffer, instance + member.offset, member.type, member.metaDataSet, _visibleNameCount);
+					size_t shift = _dataBuffer->patchLength(memberLengthPosition);
+					if (shift > 0u)
+						m_parallelShifts.push_back({ memberLengthPosition, shift, m_parallelPartIndex });
+				}
+				else if (_dataBuffer)
+				{
+					uint8_t* entries = _dataBuffer->allocate(run.entriesTemplate.size());
+					memcpy(entries, run.entriesTemplate.data(), run.entriesTemplate.size());
+					for (size_t i = 0; i < run.memberCount; ++i)
+					{
+						const ClassPlan::Member& member = plan->members[run.firstMember + i];
+						memcpy(entries + run.payloadOffsets[i], instance + member.offset, member.fixedSize);
+					}
+				}
+			}
+			if (_dataBuffer)
+			{
+				size_t shift = _dataBuffer->patchLength(lengthPosition);
+				if (shift > 0u)
+					m_parallelShifts.push_back({ lengthPosition, shift, m_parallelPartIndex });
+			}
+		}
+		else
+		{
+			// Vector of elements, as _serialize
+			size_t size = static_cast<const StdVectorTypeDesc*>(_typeDesc)->instanceGetSpan(_object).size;
+			if (_dataBuffer)
+			{
+				uint8_t encoding = ArrayEncoding_Elements;
+				_dataBuffer->writeVarint(size);
+				_dataBuffer->write(encoding);
+			}
+
+			size_t chunkElementCount = std::max(ParallelMinChunkElementCount, size / (m_writeThreadCount * 4u));
+			for (size_t firstElement = 0u; firstElement < size; firstElement += chunkElementCount)
+			{
+				_addParallelPart(_dataBuffer, _object, _typeDesc, nullptr, firstElement, std::min(chunkElementCount, size - firstElement), _visibleNameCount);
+			}
+		}
+	}
+
+	void BinarySerializer::_addParallelPart(FDataBuffer* _dataBuffer, void* _object, const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet, size_t _firstElement, size_t _elementCount, size_t _visibleNameCount)
+	{
+		if (!_dataBuffer)
+		{
+			ParallelPart part;
+			part.object = _object;
+			part.typeDesc = _typeDesc;
+			part.metaDataSet = _metaDataSet;
+			part.firstElement = _firstElement;
+			part.elementCount = _elementCount;
+			part.visibleNameCount = _visibleNameCount;
+			m_parallelParts.push_back(std::move(part));
+			return;
+		}
+
+		ParallelPart& part = m_parallelParts[m_parallelPartIndex++];
+		part.alignmentPosition = _dataBuffer->getAlignmentPosition();
+		part.position = _dataBuffer->cursor;
+		part.size = part.residueSizes[part.alignmentPosition % ParallelResidueCount];
+		_dataBuffer->allocate(part.size);
+	}
+
+	void BinarySerializer::_writeParallelPart(FDataBuffer* _dataBuffer, const ParallelPart& _part)
+	{
+		if (_part.elementCount == 0u)
+		{
+			_serialize(_dataBuffer, _part.object, _part.typeDesc, _part.metaDataSet);
+			return;
+		}
+
+		const StdVectorTypeDesc* vectorTypeDesc = static_cast<const StdVectorTypeDesc*>(_part.typeDesc);
+		StdVectorTypeDesc::Span span = vectorTypeDesc->instanceGetSpan(_part.object);
+		for (size_t i = _part.firstElement; i < _part.firstElement + _part.elementCount; ++i)
+		{
+			_serialize(_dataBuffer, span.at(i), vectorTypeDesc->getSubType());
+		}
+	}
+
+	bool BinarySerializer::_findEntry(FDataBuffer* _dataBuffer, EntryIndex& _index, const char* _id, size_t _idSize, uint32_t _idHash, uint8_t*& _outPayload, size_t& _outPayloadSize)
+	{
+		// Fast path: entries are usually read in the order they were written
+		if (!_index.isBuilt)
+		{
+			size_t entryPosition = _dataBuffer->cursor;
+			uint64_t payloadSize = 0u;
+			bool isNextEntry;
+			if (m_isReadingCompact)
+			{
+				uint32_t idHash = 0u;
+				isNextEntry = _dataBuffer->read(idHash) && idHash == _idHash && _dataBuffer->readVarint(payloadSize);
+			}
+			else
+			{
+				isNextEntry = entryPosition + _idSize <= _dataBuffer->dataLength && memcmp(_dataBuffer->data + entryPosition, _id, _idSize) == 0;
+				if (isNextEntry)
+				{
+					size_t legacyPayloadSize = 0u;
+					_dataBuffer->cursor += _idSize;
+					isNextEntry = _dataBuffer->read(legacyPayloadSize);
+					payloadSize = legacyPayloadSize;
+				}
+			}
+
+			if (isNextEntry && payloadSize <= _dataBuffer->dataLength - _dataBuffer->cursor)
+			{
+				_outPayload = _dataBuffer->data + _dataBuffer->cursor;
+				_outPayloadSize = static_cast<size_t>(payloadSize);
+				_dataBuffer->cursor += _outPayloadSize;
+				return true;
+			}
+
+			_dataBuffer->cursor = entryPosition;
+			_index.build(_dataBuffer, m_isReadingCompact);
+		}
+
+		const EntryIndex::Entry* entry = _index.find(_dataBuffer, _id, _idHash, m_isReadingCompact);
+		if (!entry)
+			return false;
+
+		_outPayload = _dataBuffer->data + entry->payloadPosition;
+		_outPayloadSize = entry->payloadSize;
+		return true;
+	}
+
+	bool BinarySerializer::_findRootEntry(const char* _id, uint32_t _idHash, uint8_t*& _outPayload, size_t& _outPayloadSize)
+	{
+		FDataBuffer* dataBuffer = &m_readDataBuffer;
+
+		// Fast path: records are usually read in the order they were written
+		while (!m_readEntryIndex.isBuilt && dataBuffer->cursor < dataBuffer->dataLength)
+		{
+			size_t recordPosition = dataBuffer->cursor;
+			uint8_t record = dataBuffer->data[dataBuffer->cursor++];
+			if (record == CompactRecord_Names || record == CompactRecord_Schemas)
+			{
+				if (record == CompactRecord_Names ? !_readNames(dataBuffer) : !_readSchemas(dataBuffer))
+					break;
+				continue;
+			}
+
+			uint32_t idHash = 0u;
+			uint64_t payloadSize = 0u;
+			if (record == CompactRecord_Entry && dataBuffer->read(idHash) && idHash == _idHash && dataBuffer->readVarint(payloadSize)
+				&& payloadSize <= dataBuffer->dataLength - dataBuffer->cursor)
+			{
+				_outPayload = dataBuffer->data + dataBuffer->cursor;
+				_outPayloadSize = static_cast<size_t>(payloadSize);
+				dataBuffer->cursor += _outPayloadSize;
+				return true;
+			}
+
+			dataBuffer->cursor = recordPosition;
+			break;
+		}
+
+		if (!m_readEntryIndex.isBuilt)
+		{
+			// Indexes all the entries, loading the name table again from the first record so that it is complete
+			m_readNames.clear();
+			dataBuffer->cursor = m_readRecordsPosition;
+			while (dataBuffer->cursor < dataBuffer->dataLength)
+			{
+				uint8_t record = dataBuffer->data[dataBuffer->cursor++];
+				if (record == CompactRecord_Names)
+				{
+					if (!_readNames(dataBuffer))
+						break;
+				}
+				else if (record == CompactRecord_Schemas)
+				{
+					if (!_readSchemas(dataBuffer))
+						break;
+				}
+				else if (record == CompactRecord_Entry)
+				{
+					uint32_t idHash = 0u;
+					uint64_t payloadSize = 0u;
+					if (!dataBuffer->read(idHash) || !dataBuffer->readVarint(payloadSize) || payloadSize > dataBuffer->dataLength - dataBuffer->cursor)
+						break;
+
+					m_readEntryIndex.add(idHash, 0u, dataBuffer->cursor, static_cast<size_t>(payloadSize));
+					dataBuffer->cursor += static_cast<size_t>(payloadSize);
+				}
+				else
+				{
+					break;
+				}
+			}
+			m_readEntryIndex.sort();
+		}
+
+		const EntryIndex::Entry* entry = m_readEntryIndex.find(dataBuffer, _id, _idHash, true);
+		if (!entry)
+			return false;
+
+		_outPayload = dataBuffer->data + entry->payloadPosition;
+		_outPayloadSize = entry->payloadSize;
+		return true;
+	}
+
+	void BinarySerializer::_readMembers(FDataBuffer* _dataBuffer, const ClassPlan* _plan, uint8_t* _instance)
+	{
+		EntryIndex index;
+		for (const ClassPlan::Member& member : _plan->members)
+		{
+			uint8_t* payload = nullptr;
+			size_t payloadSize = 0u;
+			if (_findEntry(_dataBuffer, index, member.id, member.idSize, member.idHash, payload, payloadSize))
+			{
+				FDataBuffer entryDataBuffer(payload, payloadSize);
+				_serialize(&entryDataBuffer, _instance + member.offset, member.type, member.metaDataSet);
+			}
+		}
+	}
+
+	void BinarySerializer::_serializeMembers(FDataBuffer* _dataBuffer, const Class* _class, void* _object)
+	{
+		std::vector<ClassMember*> members;
+		_class->getMembers(members);
+
+		if (m_isWriting)
+		{
+			size_t lengthPosition = _dataBuffer->reserveLength();
+			for (const ClassMember* member : members)
+			{
+				// Lengths of fixed size payloads are written as they are known, as in the templates of the plans
+				const TypeDesc* type = member->getType();
+				size_t fixedSize = GetFixedPayloadSize(type);
+				_dataBuffer->write(HashCString(member->getName()));
+				if (fixedSize > 0u)
+				{
+					_dataBuffer->writeVarint(fixedSize);
+					_serialize(_dataBuffer, member->getInstanceMemberPointer(_object), type, &member->GetMetaDataSet());
+					continue;
+				}
+				size_t memberLengthPosition = _dataBuffer->reserveLength();
+				_serialize(_dataBuffer, member->getInstanceMemberPointer(_object), type, &member->GetMetaDataSet());
+				_dataBuffer->patchLength(memberLengthPosition);
+			}
+			_dataBuffer->patchLength(lengthPosition);
+			return;
+		}
+
+		size_t dataLength = 0u;
+		if (!_readLength(_dataBuffer, dataLength) || dataLength > _dataBuffer->dataLength - _dataBuffer->cursor)
+			return;
+		FDataBuffer instanceDataBuffer = FDataBuffer(_dataBuffer->data + _dataBuffer->cursor, dataLength);
+		EntryIndex index;
+		for (const ClassMember* member : members)
+		{
+			const char* id = member->getName();
+			uint8_t* payload = nullptr;
+			size_t payloadSize = 0u;
+			if (_findEntry(&instanceDataBuffer, index, id, strlen(id) + 1, HashCString(id), payload, payloadSize))
+			{
+				FDataBuffer entryDataBuffer(payload, payloadSize);
+				_serialize(&entryDataBuffer, member->getInstanceMemberPointer(_object), member->getType(), &member->GetMetaDataSet());
+			}
+		}
+		_dataBuffer->cursor += dataLength;
+	}
+
+	bool BinarySerializer::_getPath(const char* _path, const TypeDesc* _rootTypeDesc, void* _object, const TypeDesc* _typeDesc)
+	{
+		if (!m_isReadingCompact || !_rootTypeDesc || _hasIdCollision(_rootTypeDesc))
+			return false;
+
+		const char* step = _path + strcspn(_path, ".[");
+		std::string id(_path, step);
+		uint8_t* payload = nullptr;
+		size_t payloadSize = 0u;
+		if (!_findRootEntry(id.c_str(), HashCString(id.c_str()), payload, payloadSize))
+			return false;
+
+		FDataBuffer value(payload, payloadSize);
+		const TypeDesc* typeDesc = _rootTypeDesc;
+		const MetaDataSet* metaDataSet = nullptr;
+		// Within an element of a raw block, the rest of the path is the one of a value of the block, e.g. "position.x"
+		RawBlock rawBlock;
+		const uint8_t* rawElement = nullptr;
+		std::string rawPath;
+		while (*step != '\0')
+		{
+			bool isMember = *step == '.';
+			const char* stepEnd = isMember ? step + 1 + strcspn(step + 1, ".[") : strchr(step, ']');
+			if (!stepEnd || stepEnd == step + 1)
+				return false;
+
+			std::string name(step + 1, stepEnd);
+			size_t index = 0u;
+			if (!isMember)
+			{
+				char* indexEnd = nullptr;
+				index = static_cast<size_t>(strtoull(name.c_str(), &indexEnd, 10));
+				if (*indexEnd != '\0')
+					return false;
+				++stepEnd;
+			}
+
+			if (rawElement)
+			{
+				// Only classes and arrays of classes are flattened to several values
+				const TypeDesc* nextTypeDesc = nullptr;
+				if (isMember && typeDesc->getType() == Type_Class)
+				{
+					const ClassMember* member = static_cast<const Class*>(typeDesc)->findMemberByName(name.c_str());
+					nextTypeDesc = member ? member->getType() : nullptr;
+				}
+				else if (!isMember && typeDesc->getType() == Type_FixedSizeArray && index < static_cast<const FixedSizeArrayTypeDesc*>(typeDesc)->getElementCount())
+				{
+					nextTypeDesc = static_cast<const FixedSizeArrayTypeDesc*>(typeDesc)->getSubType();
+					nextTypeDesc = GetValueRawKind(nextTypeDesc) == 0u ? nextTypeDesc : nullptr;
+				}
+				if (!nextTypeDesc)
+					return false;
+
+				rawPath += isMember && !rawPath.empty() ? "." : "";
+				rawPath.append(isMember ? step + 1 : step, stepEnd);
+				typeDesc = nextTypeDesc;
+			}
+			else if (isMember ? !_findPathMember(value, typeDesc, metaDataSet, name) : !_findPathElement(value, typeDesc, metaDataSet, index, rawBlock, rawElement))
+			{
+				return false;
+			}
+			step = stepEnd;
+		}
+
+		// Optionals are read as their value
+		if (!rawElement && typeDesc->getType() == Type_std_optional && typeDesc != _typeDesc)
+		{
+			bool hasValue = false;
+			if (!value.read(hasValue) || !hasValue)
+				return false;
+			typeDesc = static_cast<const StdOptionalTypeDesc*>(typeDesc)->getSubType();
+			value = FDataBuffer(value.data + value.cursor, value.dataLength - value.cursor);
+		}
+
+		bool isSameType = typeDesc == _typeDesc;
+		uint8_t sourceKind = GetValueRawKind(typeDesc);
+		uint8_t destinationKind = GetValueRawKind(_typeDesc);
+		bool isConverted = !isSameType && IsArithmeticSchemaKind(sourceKind) && IsArithmeticSchemaKind(destinationKind);
+		if (!isSameType && !isConverted)
+			return false;
+
+		if (rawElement)
+		{
+			// Values of the block are picked by their path, as for blocks of another layout
+			rawBlock.data = rawElement;
+			if (rawPath.empty())
+			{
+				_copyRawBlock(rawBlock, _getRawLayout(_typeDesc), 1u, reinterpret_cast<uint8_t*>(_object));
+				return true;
+			}
+
+			RawLayout layout;
+			_flattenRawFields(_typeDesc, rawPath, 0u, layout);
+			layout.elementSize = _typeDesc->getSize();
+			_copyRawBlock(rawBlock, &layout, 1u, reinterpret_cast<uint8_t*>(_object));
+			return true;
+		}
+
+		if (isConverted)
+			return ConvertRawValue(value.data, value.dataLength, sourceKind, _object, destinationKind);
+
+		_serialize(&value, _object, typeDesc, metaDataSet);
+		_endReadObjects();
+		return true;
+	}
+
+	bool BinarySerializer::_findPathMember(FDataBuffer& _value, const TypeDesc*& _typeDesc, const MetaDataSet*& _metaDataSet, const std::string& _name)
+	{
+		// Objects of owned pointers are read as their dynamic class
+		bool isOwnedPointer = _typeDesc->getType() == Type_std_unique_ptr || (_typeDesc->getType() == Type_Pointer && _metaDataSet && _metaDataSet->findMetaData("OwnedPointer"));
+		if (isOwnedPointer)
+		{
+			_typeDesc = _typeDesc->getType() == Type_Pointer ? static_cast<const PointerTypeDesc*>(_typeDesc)->getSubType() : static_cast<const StdUniquePtrTypeDesc*>(_typeDesc)->getSubType();
+			uint8_t tag = PointerTag_Null;
+			uint64_t ordinal = 0u;
+			if (!_typeDesc->hasFactory() || !_value.read(tag) || (tag == PointerTag_IdentifiedObject && !_value.readVarint(ordinal)) || (tag != PointerTag_Object && tag != PointerTag_IdentifiedObject))
+				return false;
+			if (_typeDesc->getType() == Type_Class)
+				_typeDesc = _readClassReference(&_value);
+		}
+		else if (_typeDesc->getType() == Type_std_optional)
+		{
+			bool hasValue = false;
+			if (!_value.read(hasValue) || !hasValue)
+				return false;
+			_typeDesc = static_cast<const StdOptionalTypeDesc*>(_typeDesc)->getSubType();
+		}
+		if (!_typeDesc || _typeDesc->getType() != Type_Class)
+			return false;
+
+		const ClassPlan* plan = _getClassPlan(static_cast<const Class*>(_typeDesc));
+		const ClassPlan::Member* member = nullptr;
+		for (const ClassPlan::Member& planMember : plan->members)
+		{
+			if (strcmp(planMember.id, _name.c_str()) == 0)
+			{
+				member = &planMember;
+				break;
+			}
+		}
+		size_t dataLength = 0u;
+		if (!member || !_readLength(&_value, dataLength) || dataLength > _value.dataLength - _value.cursor)
+			return false;
+
+		FDataBuffer classDataBuffer(_value.data + _value.cursor, dataLength);
+		uint8_t* payload = nullptr;
+		size_t payloadSize = 0u;
+		if (m_indexPaths)
+		{
+			EntryIndex& index = m_pathMemberIndices[static_cast<size_t>(classDataBuffer.data - m_readDataBuffer.data)];
+			if (!index.isBuilt)
+				index.build(&classDataBuffer, true);
+			const EntryIndex::Entry* entry = index.find(&classDataBuffer, member->id, member->idHash, true);
+			if (!entry)
+				return false;
+			payload = classDataBuffer.data + entry->payloadPosition;
+			payloadSize = entry->payloadSize;
+		}
+		else
+		{
+			EntryIndex index;
+			if (!_findEntry(&classDataBuffer, index, member->id, member->idSize, member->idHash, payload, payloadSize))
+				return false;
+		}
+
+		_value = FDataBuffer(payload, payloadSize);
+		_typeDesc = member->type;
+		_metaDataSet = member->metaDataSet;
+		return true;
+	}
+
+	bool BinarySerializer::_findPathElement(FDataBuffer& _value, const TypeDesc*& _typeDesc, const MetaDataSet*& _metaDataSet, size_t _index, RawBlock& _outRawBlock, const uint8_t*& _outRawElement)
+	{
+		const TypeDesc* subType = nullptr;
+		size_t count = 0u;
+		uint8_t encoding = ArrayEncoding_Elements;
+		if (_typeDesc->getType() == Type_std_vector)
+		{
+			subType = static_cast<const StdVectorTypeDesc*>(_typeDesc)->getSubType();
+			if (!_readLength(&_value, count) || _index >= count || !_value.read(encoding))
+				return false;
+		}
+		else if (_typeDesc->getType() == Type_FixedSizeArray)
+		{
+			subType = static_cast<const FixedSizeArrayTypeDesc*>(_typeDesc)->getSubType();
+			count = static_cast<const FixedSizeArrayTypeDesc*>(_typeDesc)->getElementCount();
+			if (_index >= count)
+				return false;
+
+			// Arrays of arithmetic values are their raw memory, element after element
+			size_t elementSize = GetFixedPayloadSize(subType);
+			if (GetFixedPayloadSize(_typeDesc) > 0u)
+			{
+				if (elementSize * count > _value.dataLength - _value.cursor)
+					return false;
+				_value = FDataBuffer(_value.data + _value.cursor + _index * elementSize, elementSize);
+				_typeDesc = subType;
+				_metaDataSet = nullptr;
+				return true;
+			}
+			if (!_value.read(encoding))
+				return false;
+		}
+		else
+		{
+			return false;
+		}
+
+		// Deltas only hold the elements that changed
+		if (encoding == ArrayEncoding_Delta)
+			return false;
+
+		if (encoding != ArrayEncoding_Elements)
+		{
+			if (!_readRawBlock(&_value, encoding, count, _outRawBlock))
+				return false;
+			_outRawElement = _outRawBlock.data + _index * _outRawBlock.elementSize;
+			_typeDesc = subType;
+			_metaDataSet = nullptr;
+			return true;
+		}
+
+		// Elements written one by one are skipped up to the one at _index
+		size_t elementPosition = 0u;
+		size_t elementEndPosition = 0u;
+		if (m_indexPaths)
+		{
+			std::vector<size_t>& positions = m_pathElementPositions[static_cast<size_t>(_value.data + _value.cursor - m_readDataBuffer.data)];
+			if (positions.empty())
+			{
+				positions.reserve(count + 1u);
+				positions.push_back(_value.cursor);
+				for (size_t i = 0; i < count; ++i)
+				{
+					if (!_skipValue(&_value, subType, nullptr))
+					{
+						positions.clear();
+						return false;
+					}
+					positions.push_back(_value.cursor);
+				}
+			}
+			elementPosition = positions[_index];
+			elementEndPosition = positions[_index + 1u];
+		}
+		else
+		{
+			for (size_t i = 0; i < _index; ++i)
+			{
+				if (!_skipValue(&_value, subType, nullptr))
+					return false;
+			}
+			elementPosition = _value.cursor;
+			if (!_skipValue(&_value, subType, nullptr))
+				return false;
+			elementEndPosition = _value.cursor;
+		}
+
+		_value = FDataBuffer(_value.data + elementPosition, elementEndPosition - elementPosition);
+		_typeDesc = subType;
+		_metaDataSet = nullptr;
+		return true;
+	}
+
+	bool BinarySerializer::_skipValue(FDataBuffer* _dataBuffer, const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet)
+	{
+		if (!_typeDesc)
+			return false;
+
+		size_t remainingSize = _dataBuffer->dataLength - _dataBuffer->cursor;
+		size_t fixedPayloadSize = GetFixedPayloadSize(_typeDesc);
+		if (fixedPayloadSize > 0u)
+		{
+			if (fixedPayloadSize > remainingSize)
+				return false;
+			_dataBuffer->cursor += fixedPayloadSize;
+			return true;
+		}
+
+		switch (_typeDesc->getType())
+		{
+		case Type_Class:
+		case Type_std_string:
+		case Type_std_string_view:
+		{
+			// Length prefixed
+			size_t length = 0u;
+			if (!_readLength(_dataBuffer, length) || length > _dataBuffer->dataLength - _dataBuffer->cursor)
+				return false;
+			_dataBuffer->cursor += length;
+			return true;
+		}
+		case Type_Enum:
+		{
+			uint64_t reference = 0u;
+			uint64_t value = 0u;
+			return _dataBuffer->readVarint(reference) && (reference != 0u || _dataBuffer->readVarint(value));
+		}
+		case Type_std_unique_ptr:
+		case Type_Pointer:
+		{
+			bool isOwnedPointer = _typeDesc->getType() == Type_std_unique_ptr || (_metaDataSet && _metaDataSet->findMetaData("OwnedPointer"));
+			const TypeDesc* subType = _typeDesc->getType() == Type_Pointer ? static_cast<const PointerTypeDesc*>(_typeDesc)->getSubType() : static_cast<const StdUniquePtrTypeDesc*>(_typeDesc)->getSubType();
+			// Owned pointers to types without factory, and other pointers before version 2, are not written
+			if (isOwnedPointer ? !subType->hasFactory() : m_readVersion < 2u)
+				return true;
+
+			uint8_t tag = PointerTag_Null;
+			uint64_t ordinal = 0u;
+			if (!_dataBuffer->read(tag))
+				return false;
+			if (tag == PointerTag_Null)
+				return true;
+			if (tag == PointerTag_Reference)
+				return _dataBuffer->readVarint(ordinal);
+			if ((tag != PointerTag_Object && tag != PointerTag_IdentifiedObject) || (tag == PointerTag_IdentifiedObject && !_dataBuffer->readVarint(ordinal)))
+				return false;
+
+			if (subType->getType() == Type_Class)
+			{
+				uint64_t reference = 0u;
+				if (!_dataBuffer->readVarint(reference))
+					return false;
+				if (reference == 0u && !_skipValue(_dataBuffer, GetTypeDesc<std::string>(), nullptr))
+					return false;
+			}
+			return _skipValue(_dataBuffer, subType, nullptr);
+		}
+		case Type_std_vector:
+		case Type_std_span:
+		case Type_FixedSizeArray:
+		{
+			const TypeDesc* subType = nullptr;
+			size_t count = 0u;
+			if (_typeDesc->getType() == Type_FixedSizeArray)
+			{
+				subType = static_cast<const FixedSizeArrayTypeDesc*>(_typeDesc)->getSubType();
+				count = static_cast<const FixedSizeArrayTypeDesc*>(_typeDesc)->getElementCount();
+			}
+			else
+			{
+				subType = _typeDesc->getType() == Type_std_vector ? static_cast<const StdVectorTypeDesc*>(_typeDesc)->getSubType() : static_cast<const StdSpanTypeDesc*>(_typeDesc)->getSubType();
+				if (!_readLength(_dataBuffer, count))
+					return false;
+				if (count == 0u)
+					return true;
+			}
+
+			uint8_t encoding = ArrayEncoding_Elements;
+			if (!_dataBuffer->read(encoding))
+				return false;
+			if (encoding == ArrayEncoding_Delta)
+			{
+				uint64_t gap = 0u;
+				size_t runLength = 0u;
+				while (_dataBuffer->readVarint(gap) && gap > 0u)
+				{
+					if (!_readLength(_dataBuffer, runLength) || runLength > _dataBuffer->dataLength - _dataBuffer->cursor)
+						return false;
+					_dataBuffer->cursor += runLength;
+				}
+				return gap == 0u;
+			}
+			if (encoding != ArrayEncoding_Elements)
+			{
+				RawBlock block;
+				return _readRawBlock(_dataBuffer, encoding, count, block);
+			}
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (!_skipValue(_dataBuffer, subType, nullptr))
+					return false;
+			}
+			return true;
+		}
+		case Type_std_optional:
+		{
+			bool hasValue = false;
+			return _dataBuffer->read(hasValue) && (!hasValue || _skipValue(_dataBuffer, static_cast<const StdOptionalTypeDesc*>(_typeDesc)->getSubType(), nullptr));
+		}
+		case Type_std_pair:
+		{
+			const StdPairTypeDesc* pairTypeDesc = static_cast<const StdPairTypeDesc*>(_typeDesc);
+			return _skipValue(_dataBuffer, pairTypeDesc->getFirstType(), nullptr) && _skipValue(_dataBuffer, pairTypeDesc->getSecondType(), nullptr);
+		}
+		case Type_std_map:
+		case Type_std_unordered_map:
+		{
+			const StdMapTypeDesc* mapTypeDesc = static_cast<const StdMapTypeDesc*>(_typeDesc);
+			size_t mapSize = 0u;
+			if (!_readLength(_dataBuffer, mapSize))
+				return false;
+			for (size_t i = 0; i < mapSize; ++i)
+			{
+				if (!_skipValue(_dataBuffer, mapTypeDesc->getKeyType(), nullptr) || !_skipValue(_dataBuffer, mapTypeDesc->getValueType(), nullptr))
+					return false;
+			}
+			return true;
+		}
+		default:
+			return false;
+		}
+	}
+
+	size_t BinarySerializer::_decodeIncremental(const uint8_t* _data, size_t _dataLength)
+	{
+		size_t decodedSize = 0u;
+		m_incrementalNeededSize = 0u;
+
+		if (m_incrementalPosition == 0u)
+		{
+			if (_dataLength < CompactFormatHeaderSize)
+			{
+				m_incrementalNeededSize = CompactFormatHeaderSize;
+				return 0u;
+			}
+
+			// The legacy format is only read from memory
+			if (memcmp(_data, CompactFormatMagic, sizeof(CompactFormatMagic)) != 0 || _data[sizeof(CompactFormatMagic)] > CompactFormatVersion)
+			{
+				m_hasIncrementalFailed = true;
+				return 0u;
+			}
+			m_readVersion = _data[sizeof(CompactFormatMagic)];
+			decodedSize = CompactFormatHeaderSize;
+		}
+
+		while (!m_hasIncrementalFailed)
+		{
+			IncrementalFrame& frame = m_incrementalFrames.back();
+			size_t position = m_incrementalPosition + decodedSize;
+			if (position == frame.endPosition)
+			{
+				m_incrementalFrames.pop_back();
+				continue;
+			}
+
+			// Bytes of the frame at hand
+			size_t frameSize = frame.endPosition - position;
+			size_t availableSize = std::min(_dataLength - decodedSize, frameSize);
+			if (availableSize == 0u)
+			{
+				m_incrementalNeededSize = 1u;
+				break;
+			}
+			const uint8_t* bytes = _data + decodedSize;
+			FDataBuffer dataBuffer(const_cast<uint8_t*>(bytes), availableSize);
+			bool isFrameAvailable = availableSize == frameSize;
+
+			// Headers whose size is not known wait for one more byte, descriptions for twice as many
+			size_t headerNeededSize = availableSize + 1u;
+			size_t descriptionNeededSize = std::min(availableSize * 2u, frameSize);
+
+			switch (frame.kind)
+			{
+			case IncrementalFrame::Kind_Records:
+			{
+				uint8_t record = 0u;
+				dataBuffer.read(record);
+				if (record == CompactRecord_Names)
+				{
+					size_t nameCount = m_readNames.size();
+					if (!_readNames(&dataBuffer))
+					{
+						m_readNames.resize(nameCount);
+						m_incrementalNeededSize = availableSize * 2u + 16u;
+						return decodedSize;
+					}
+					decodedSize += dataBuffer.cursor;
+				}
+				else if (record == CompactRecord_Schemas)
+				{
+					if (!_readSchemas(&dataBuffer))
+					{
+						m_incrementalNeededSize = availableSize * 2u + 16u;
+						return decodedSize;
+					}
+					decodedSize += dataBuffer.cursor;
+				}
+				else if (record == CompactRecord_Entry)
+				{
+					uint32_t idHash = 0u;
+					uint64_t payloadSize = 0u;
+					if (!dataBuffer.read(idHash) || !dataBuffer.readVarint(payloadSize))
+					{
+						m_incrementalNeededSize = headerNeededSize;
+						return decodedSize;
+					}
+
+					// Pointers of the previous entry are complete
+					_endReadObjects();
+
+					IncrementalFrame entryFrame;
+					entryFrame.kind = IncrementalFrame::Kind_Skip;
+					entryFrame.endPosition = position + dataBuffer.cursor + static_cast<size_t>(payloadSize);
+					for (const IncrementalTarget& target : m_incrementalTargets)
+					{
+						if (target.idHash == idHash)
+						{
+							entryFrame.kind = IncrementalFrame::Kind_Value;
+							entryFrame.object = reinterpret_cast<uint8_t*>(target.object);
+							entryFrame.typeDesc = target.typeDesc;
+							entryFrame.metaDataSet = target.metaDataSet;
+							break;
+						}
+					}
+					decodedSize += dataBuffer.cursor;
+					m_incrementalFrames.push_back(entryFrame);
+				}
+				else
+				{
+					m_hasIncrementalFailed = true;
+				}
+			}
+			break;
+			case IncrementalFrame::Kind_Skip:
+			{
+				decodedSize += availableSize;
+			}
+			break;
+			case IncrementalFrame::Kind_ConvertedValue:
+			{
+				if (!isFrameAvailable)
+				{
+					m_incrementalNeededSize = frameSize;
+					return decodedSize;
+				}
+				ConvertRawValue(bytes, availableSize, frame.sourceKind, frame.object, frame.targetKind);
+				decodedSize += availableSize;
+				m_incrementalFrames.pop_back();
+			}
+			break;
+			case IncrementalFrame::Kind_Value:
+			{
+				if (isFrameAvailable)
+				{
+					_serialize(&dataBuffer, frame.object, frame.typeDesc, frame.metaDataSet);
+					decodedSize += availableSize;
+					m_incrementalFrames.pop_back();
+					break;
+				}
+
+				if (frame.typeDesc->getType() == Type_Class)
+				{
+					size_t dataLength = 0u;
+					if (!_readLength(&dataBuffer, dataLength))
+					{
+						m_incrementalNeededSize = headerNeededSize;
+						return decodedSize;
+					}
+					if (dataBuffer.cursor + dataLength != frameSize)
+					{
+						m_hasIncrementalFailed = true;
+						break;
+					}
+
+					frame.kind = IncrementalFrame::Kind_Members;
+					frame.plan = _getClassPlan(static_cast<const Class*>(frame.typeDesc));
+					decodedSize += dataBuffer.cursor;
+				}
+				else if (frame.typeDesc->getType() == Type_std_vector)
+				{
+					const StdVectorTypeDesc* vectorTypeDesc = static_cast<const StdVectorTypeDesc*>(frame.typeDesc);
+					const TypeDesc* subType = vectorTypeDesc->getSubType();
+					size_t vectorSize = 0u;
+					uint8_t encoding = ArrayEncoding_Elements;
+					if (!_readLength(&dataBuffer, vectorSize) || !dataBuffer.read(encoding))
+					{
+						m_incrementalNeededSize = headerNeededSize;
+						return decodedSize;
+					}
+
+					if (encoding == ArrayEncoding_Elements || encoding == ArrayEncoding_Delta)
+					{
+						if (encoding == ArrayEncoding_Delta || (subType->getType() != Type_Class && subType->getType() != Type_std_string))
+						{
+							m_incrementalNeededSize = frameSize;
+							return decodedSize;
+						}
+
+						// Elements take at least a byte each
+						if (vectorSize > frameSize - dataBuffer.cursor)
+						{
+							m_hasIncrementalFailed = true;
+							break;
+						}
+						frame.kind = IncrementalFrame::Kind_Elements;
+					}
+					else
+					{
+						RawBlock block;
+						if (!_readRawBlock(&dataBuffer, encoding, 0u, block))
+						{
+							m_incrementalNeededSize = descriptionNeededSize;
+							if (m_incrementalNeededSize <= availableSize)
+								m_hasIncrementalFailed = true;
+							return decodedSize;
+						}
+						if (vectorSize > (frameSize - dataBuffer.cursor) / block.elementSize)
+						{
+							m_hasIncrementalFailed = true;
+							break;
+						}
+
+						frame.kind = IncrementalFrame::Kind_RawValues;
+						frame.rawDescription.assign(block.description, block.description + block.descriptionSize);
+						frame.rawBlock = block;
+						frame.rawBlock.description = frame.rawDescription.data();
+					}
+
+					frame.index = 0u;
+					frame.count = vectorSize;
+					vectorTypeDesc->instanceResize(frame.object, vectorSize);
+					decodedSize += dataBuffer.cursor;
+				}
+				else
+				{
+					m_incrementalNeededSize = frameSize;
+					return decodedSize;
+				}
+			}
+			break;
+			case IncrementalFrame::Kind_Members:
+			{
+				uint32_t idHash = 0u;
+				uint64_t payloadSize = 0u;
+				if (!dataBuffer.read(idHash) || !dataBuffer.readVarint(payloadSize))
+				{
+					if (isFrameAvailable)
+						m_hasIncrementalFailed = true;
+					m_incrementalNeededSize = headerNeededSize;
+					return decodedSize;
+				}
+				if (payloadSize > frameSize - dataBuffer.cursor)
+				{
+					m_hasIncrementalFailed = true;
+					break;
+				}
+
+				IncrementalFrame memberFrame;
+				memberFrame.kind = IncrementalFrame::Kind_Skip;
+				memberFrame.endPosition = position + dataBuffer.cursor + static_cast<size_t>(payloadSize);
+				const ReadSchema* schema = _getReadSchema(frame.plan);
+				if (schema)
+				{
+					// Members are found through the schema, which also tells the ones to convert
+					for (const ReadSchema::Member& member : schema->members)
+					{
+						if (member.idHash == idHash)
+						{
+							if (member.target)
+							{
+								memberFrame.kind = member.isConverted ? IncrementalFrame::Kind_ConvertedValue : IncrementalFrame::Kind_Value;
+								memberFrame.object = frame.object + member.target->offset;
+								memberFrame.typeDesc = member.target->type;
+								memberFrame.metaDataSet = member.target->metaDataSet;
+								memberFrame.sourceKind = member.kind;
+								memberFrame.targetKind = member.targetKind;
+							}
+							break;
+						}
+					}
+				}
+				else
+				{
+					for (const ClassPlan::Member& member : frame.plan->members)
+					{
+						if (member.idHash == idHash)
+						{
+							memberFrame.kind = IncrementalFrame::Kind_Value;
+							memberFrame.object = frame.object + member.offset;
+							memberFrame.typeDesc = member.type;
+							memberFrame.metaDataSet = member.metaDataSet;
+							break;
+						}
+					}
+				}
+				decodedSize += dataBuffer.cursor;
+				m_incrementalFrames.push_back(memberFrame);
+			}
+			break;
+			case IncrementalFrame::Kind_Elements:
+			{
+				const StdVectorTypeDesc* vectorTypeDesc = static_cast<const StdVectorTypeDesc*>(frame.typeDesc);
+				uint64_t elementLength = 0u;
+				if (frame.index == frame.count || !dataBuffer.readVarint(elementLength))
+				{
+					if (frame.index == frame.count || isFrameAvailable)
+						m_hasIncrementalFailed = true;
+					m_incrementalNeededSize = headerNeededSize;
+					return decodedSize;
+				}
+				if (elementLength > frameSize - dataBuffer.cursor)
+				{
+					m_hasIncrementalFailed = true;
+					break;
+				}
+
+				// Decoded from the start of the element, length included
+				IncrementalFrame elementFrame;
+				elementFrame.kind = IncrementalFrame::Kind_Value;
+				elementFrame.endPosition = position + dataBuffer.cursor + static_cast<size_t>(elementLength);
+				elementFrame.object = reinterpret_cast<uint8_t*>(vectorTypeDesc->instanceGetSpan(frame.object).at(frame.index));
+				elementFrame.typeDesc = vectorTypeDesc->getSubType();
+				++frame.index;
+				m_incrementalFrames.push_back(elementFrame);
+			}
+			break;
+			case IncrementalFrame::Kind_RawValues:
+			{
+				const StdVectorTypeDesc* vectorTypeDesc = static_cast<const StdVectorTypeDesc*>(frame.typeDesc);
+				const RawLayout* rawLayout = _getRawLayout(vectorTypeDesc->getSubType());
+				size_t elementCount = std::min(availableSize / frame.rawBlock.elementSize, frame.count - frame.index);
+				if (elementCount == 0u)
+				{
+					if (frame.index == frame.count)
+						m_hasIncrementalFailed = true;
+					m_incrementalNeededSize = frame.rawBlock.elementSize;
+					return decodedSize;
+				}
+
+				uint8_t* destination = reinterpret_cast<uint8_t*>(vectorTypeDesc->instanceGetSpan(frame.object).data) + frame.index * rawLayout->elementSize;
+				frame.rawBlock.data = bytes;
+				_copyRawBlock(frame.rawBlock, rawLayout, elementCount, destination);
+				frame.index += elementCount;
+				decodedSize += elementCount * frame.rawBlock.elementSize;
+			}
+			break;
+			}
+		}
+
+		return decodedSize;
+	}
+
+	void BinarySerializer::EntryIndex::add(uint32_t _idHash, size_t _idPosition, size_t _payloadPosition, size_t _payloadSize)
+	{
+		Entry entry;
+		entry.idHash = _idHash;
+		entry.idPosition = _idPosition;
+		entry.payloadPosition = _payloadPosition;
+		entry.payloadSize = _payloadSize;
+		entries.push_back(entry);
+	}
+
+	void BinarySerializer::EntryIndex::sort()
+	{
+		// Stable so that the first of several entries with the same id is found, as before indexing
+		std::stable_sort(entries.begin(), entries.end(), [](const Entry& _a, const Entry& _b) { return _a.idHash < _b.idHash; });
+		isBuilt = true;
+	}
+
+	void BinarySerializer::EntryIndex::build(const FDataBuffer* _dataBuffer, bool _isCompact)
+	{
+		entries.clear();
+
+		size_t cursor = 0u;
+		while (cursor < _dataBuffer->dataLength)
+		{
+			size_t idPosition = cursor;
+			uint32_t idHash = 0u;
+			uint64_t payloadSize = 0u;
+			if (_isCompact)
+			{
+				if (cursor + sizeof(idHash) > _dataBuffer->dataLength)
+					break;
+
+				memcpy(&idHash, _dataBuffer->data + cursor, sizeof(idHash));
+				cursor += sizeof(idHash);
+				if (!ReadVarint(_dataBuffer->data, _dataBuffer->dataLength, cursor, payloadSize))
+					break;
+			}
+			else
+			{
+				const uint8_t* id = _dataBuffer->data + cursor;
+				const uint8_t* idEnd = reinterpret_cast<const uint8_t*>(memchr(id, 0, _dataBuffer->dataLength - cursor));
+				if (!idEnd)
+					break;
+
+				idHash = HashCString(reinterpret_cast<const char*>(id));
+				cursor += (idEnd - id) + 1;
+				if (cursor + sizeof(size_t) > _dataBuffer->dataLength)
+					break;
+
+				size_t legacyPayloadSize = 0u;
+				memcpy(&legacyPayloadSize, _dataBuffer->data + cursor, sizeof(legacyPayloadSize));
+				cursor += sizeof(legacyPayloadSize);
+				payloadSize = legacyPayloadSize;
+			}
+
+			if (payloadSize > _dataBuffer->dataLength - cursor)
+				break;
+
+			add(idHash, idPosition, cursor, static_cast<size_t>(payloadSize));
+			cursor += static_cast<size_t>(payloadSize);
+		}
+
+		sort();
+	}
+
+	const BinarySerializer::EntryIndex::Entry* BinarySerializer::EntryIndex::find(const FDataBuffer* _dataBuffer, const char* _id, uint32_t _idHash, bool _isCompact) const
+	{
+		// Legacy ids are hashed when indexed, and compared in full since they are stored in full
+		uint32_t idHash = _isCompact ? _idHash : HashCString(_id);
+		auto it = std::lower_bound(entries.begin(), entries.end(), idHash, [](const Entry& _entry, uint32_t _idHash) { return _entry.idHash < _idHash; });
+		for (; it != entries.end() && it->idHash == idHash; ++it)
+		{
+			if (_isCompact || strcmp(reinterpret_cast<const char*>(_dataBuffer->data + it->idPosition), _id) == 0)
+				return &*it;
+		}
+		return nullptr;
+	}
+
+	// Collects the names a value of _typeDesc may refer to. Classes behind owned pointers add their names and the ones of their children.
+	static void CollectReachableNames(const TypeDesc* _typeDesc, bool _isOwned, std::unordered_set<const TypeDesc*>& _visitedTypes, std::unordered_set<const char*>& _names, std::vector<const char*>& _outNames)
+	{
+		if (!_typeDesc)
+			return;
+
+		if (_isOwned && _typeDesc->getType() == Type_Class)
+		{
+			const Class* clss = static_cast<const Class*>(_typeDesc);
+			if (!_names.insert(clss->getName()).second)
+				return;
+			_outNames.push_back(clss->getName());
+
+			// Sorted so that the output does not depend on the addresses of the classes
+			std::vector<const Class*> children(clss->getChildren().begin(), clss->getChildren().end());
+			std::sort(children.begin(), children.end(), [](const Class* _a, const Class* _b) { return strcmp(_a->getName(), _b->getName()) < 0; });
+			for (const Class* child : children)
+			{
+				CollectReachableNames(child, true, _visitedTypes, _names, _outNames);
+			}
+		}
+
+		if (!_visitedTypes.insert(_typeDesc).second)
+			return;
+
+		switch (_typeDesc->getType())
+		{
+		case Type_Enum:
+			for (const EnumValue* enumValue : static_cast<const Enum*>(_typeDesc)->getValues())
+			{
+				if (_names.insert(enumValue->getName()).second)
+					_outNames.push_back(enumValue->getName());
+			}
+			break;
+		case Type_Class:
+		{
+			std::vector<ClassMember*> members;
+			static_cast<const Class*>(_typeDesc)->getMembers(members);
+			for (const ClassMember* member : members)
+			{
+				CollectReachableNames(member->getType(), false, _visitedTypes, _names, _outNames);
+			}
+		}
+		break;
+		case Type_Pointer:
+			CollectReachableNames(static_cast<const PointerTypeDesc*>(_typeDesc)->getSubType(), true, _visitedTypes, _names, _outNames);
+			break;
+		case Type_std_unique_ptr:
+			CollectReachableNames(static_cast<const StdUniquePtrTypeDesc*>(_typeDesc)->getSubType(), true, _visitedTypes, _names, _outNames);
+			break;
+		case Type_std_vector:
+			CollectReachableNames(static_cast<const StdVectorTypeDesc*>(_typeDesc)->getSubType(), false, _visitedTypes, _names, _outNames);
+			break;
+		case Type_std_optional:
+			CollectReachableNames(static_cast<const StdOptionalTypeDesc*>(_typeDesc)->getSubType(), false, _visitedTypes, _names, _outNames);
+			break;
+		case Type_FixedSizeArray:
+			CollectReachableNames(static_cast<const FixedSizeArrayTypeDesc*>(_typeDesc)->getSubType(), false, _visitedTypes, _names, _outNames);
+			break;
+		case Type_std_pair:
+			CollectReachableNames(static_cast<const StdPairTypeDesc*>(_typeDesc)->getFirstType(), false, _visitedTypes, _names, _outNames);
+			CollectReachableNames(static_cast<const StdPairTypeDesc*>(_typeDesc)->getSecondType(), false, _visitedTypes, _names, _outNames);
+			break;
+		case Type_std_map:
+		case Type_std_unordered_map:
+			CollectReachableNames(static_cast<const StdMapTypeDesc*>(_typeDesc)->getKeyType(), false, _visitedTypes, _names, _outNames);
+			CollectReachableNames(static_cast<const StdMapTypeDesc*>(_typeDesc)->getValueType(), false, _visitedTypes, _names, _outNames);
+			break;
+		default:
+			break;
+		}
+	}
+
+	const std::vector<const char*>& BinarySerializer::_getReachableNames(const TypeDesc* _typeDesc)
+	{
+		auto it = m_reachableNames.find(_typeDesc);
+		if (it != m_reachableNames.end())
+			return it->second;
+
+		std::vector<const char*>& names = m_reachableNames[_typeDesc];
+		std::unordered_set<const TypeDesc*> visitedTypes;
+		std::unordered_set<const char*> nameSet;
+		CollectReachableNames(_typeDesc, false, visitedTypes, nameSet, names);
+		return names;
+	}
+
+	// Collects the classes a value of _typeDesc may write, with the children of the classes behind pointers
+	static void CollectReachableClasses(const TypeDesc* _typeDesc, bool _isOwned, std::unordered_set<const TypeDesc*>& _visitedTypes, std::vector<const Class*>& _outClasses)
+	{
+		if (!_typeDesc)
+			return;
+
+		if (_isOwned && _typeDesc->getType() == Type_Class)
+		{
+			std::vector<const Class*> children(static_cast<const Class*>(_typeDesc)->getChildren().begin(), static_cast<const Class*>(_typeDesc)->getChildren().end());
+			std::sort(children.begin(), children.end(), [](const Class* _a, const Class* _b) { return strcmp(_a->getName(), _b->getName()) < 0; });
+			for (const Class* child : children)
+			{
+				CollectReachableClasses(child, true, _visitedTypes, _outClasses);
+			}
+		}
+
+		if (!_visitedTypes.insert(_typeDesc).second)
+			return;
+
+		switch (_typeDesc->getType())
+		{
+		case Type_Class:
+		{
+			_outClasses.push_back(static_cast<const Class*>(_typeDesc));
+			std::vector<ClassMember*> members;
+			static_cast<const Class*>(_typeDesc)->getMembers(members);
+			for (const ClassMember* member : members)
+			{
+				CollectReachableClasses(member->getType(), false, _visitedTypes, _outClasses);
+			}
+		}
+		break;
+		case Type_Pointer:
+			CollectReachableClasses(static_cast<const PointerTypeDesc*>(_typeDesc)->getSubType(), true, _visitedTypes, _outClasses);
+			break;
+		case Type_std_unique_ptr:
+			CollectReachableClasses(static_cast<const StdUniquePtrTypeDesc*>(_typeDesc)->getSubType(), true, _visitedTypes, _outClasses);
+			break;
+		case Type_std_vector:
+			CollectReachableClasses(static_cast<const StdVectorTypeDesc*>(_typeDesc)->getSubType(), false, _visitedTypes, _outClasses);
+			break;
+		case Type_std_optional:
+			CollectReachableClasses(static_cast<const StdOptionalTypeDesc*>(_typeDesc)->getSubType(), false, _visitedTypes, _outClasses);
+			break;
+		case Type_FixedSizeArray:
+			CollectReachableClasses(static_cast<const FixedSizeArrayTypeDesc*>(_typeDesc)->getSubType(), false, _visitedTypes, _outClasses);
+			break;
+		case Type_std_pair:
+			CollectReachableClasses(static_cast<const StdPairTypeDesc*>(_typeDesc)->getFirstType(), false, _visitedTypes, _outClasses);
+			CollectReachableClasses(static_cast<const StdPairTypeDesc*>(_typeDesc)->getSecondType(), false, _visitedTypes, _outClasses);
+			break;
+		case Type_std_map:
+		case Type_std_unordered_map:
+			CollectReachableClasses(static_cast<const StdMapTypeDesc*>(_typeDesc)->getKeyType(), false, _visitedTypes, _outClasses);
+			CollectReachableClasses(static_cast<const StdMapTypeDesc*>(_typeDesc)->getValueType(), false, _visitedTypes, _outClasses);
+			break;
+		default:
+			break;
+		}
+	}
+
+	const std::vector<const Class*>& BinarySerializer::_getReachableClasses(const TypeDesc* _typeDesc)
+	{
+		auto it = m_reachableClasses.find(_typeDesc);
+		if (it != m_reachableClasses.end())
+			return it->second;
+
+		std::vector<const Class*>& classes = m_reachableClasses[_typeDesc];
+		std::unordered_set<const TypeDesc*> visitedTypes;
+		CollectReachableClasses(_typeDesc, false, visitedTypes, classes);
+		return classes;
+	}
+
+	bool BinarySerializer::_hasIdCollision(const TypeDesc* _typeDesc)
+	{
+		for (const Class* clss : _getReachableClasses(_typeDesc))
+		{
+			if (_getClassPlan(clss)->hasIdCollision)
+				return true;
+		}
+		return false;
+	}
+
+	void BinarySerializer::_writeSchemas(const std::vector<const Class*>& _classes)
+	{
+		size_t classCount = 0u;
+		for (const Class* clss : _classes)
+		{
+			classCount += m_writeSchemaClasses.count(clss) == 0u ? 1u : 0u;
+		}
+		if (classCount == 0u)
+			return;
+
+		uint8_t record = CompactRecord_Schemas;
+		m_writeDataBuffer->write(record);
+		m_writeDataBuffer->writeVarint(classCount);
+		for (const Class* clss : _classes)
+		{
+			if (!m_writeSchemaClasses.insert(clss).second)
+				continue;
+
+			const ClassPlan* plan = _getClassPlan(clss);
+			m_writeDataBuffer->write(plan->classNameHash);
+			m_writeDataBuffer->write(plan->fingerprint);
+			m_writeDataBuffer->writeVarint(plan->members.size());
+			m_writeDataBuffer->write(plan->schema.data(), plan->schema.size());
+		}
+	}
+
+	bool BinarySerializer::_readSchemas(FDataBuffer* _dataBuffer)
+	{
+		// Parsed whole before being added, so that incomplete records can be read again
+		uint64_t classCount = 0u;
+		if (!_dataBuffer->readVarint(classCount))
+			return false;
+
+		std::vector<std::pair<uint32_t, ReadSchema>> schemas;
+		for (uint64_t i = 0; i < classCount; ++i)
+		{
+			uint32_t classNameHash = 0u;
+			ReadSchema schema;
+			uint64_t memberCount = 0u;
+			if (!_dataBuffer->read(classNameHash) || !_dataBuffer->read(schema.fingerprint) || !_dataBuffer->readVarint(memberCount))
+				return false;
+
+			// Members take at least 6 bytes each
+			if (memberCount > (_dataBuffer->dataLength - _dataBuffer->cursor) / 6u)
+				return false;
+			schema.members.resize(static_cast<size_t>(memberCount));
+			for (ReadSchema::Member& member : schema.members)
+			{
+				uint64_t fixedSize = 0u;
+				if (!_dataBuffer->read(member.idHash) || !_dataBuffer->read(member.kind) || !_dataBuffer->readVarint(fixedSize))
+					return false;
+				if (m_readVersion >= 5u && (member.kind & SchemaKind_TypeBit) != 0u && !_dataBuffer->read(member.typeHash))
+					return false;
+				member.fixedSize = static_cast<size_t>(fixedSize);
+			}
+			schemas.push_back(std::make_pair(classNameHash, std::move(schema)));
+		}
+
+		// The schemas already read are kept, the classes may already point to them
+		for (auto& pair : schemas)
+		{
+			m_readSchemas.insert(std::move(pair));
+		}
+		return true;
+	}
+
+	const BinarySerializer::ReadSchema* BinarySerializer::_getReadSchema(const ClassPlan* _plan)
+	{
+		if (_plan->readSchemaGeneration == m_readSchemaGeneration)
+			return _plan->readSchema;
+
+		// Data written before the schemas, or classes whose schema is not read yet
+		if (m_readVersion < 3u)
+			return nullptr;
+		auto it = m_readSchemas.find(_plan->classNameHash);
+		if (it == m_readSchemas.end())
+			return nullptr;
+
+		ReadSchema& schema = it->second;
+		if (!schema.isMapped)
+		{
+			// Same fingerprint: the members are the same, in the same order
+			bool isSameSchema = schema.fingerprint == _plan->fingerprint && schema.members.size() == _plan->members.size();
+			for (size_t i = 0; i < schema.members.size(); ++i)
+			{
+				ReadSchema::Member& member = schema.members[i];
+				if (isSameSchema && _plan->members[i].idHash == member.idHash)
+				{
+					member.target = &_plan->members[i];
+				}
+				else
+				{
+					for (const ClassPlan::Member& planMember : _plan->members)
+					{
+						if (planMember.idHash == member.idHash)
+						{
+							member.target = &planMember;
+							break;
+						}
+					}
+				}
+				if (!member.target)
+					continue;
+
+				uint8_t targetKind = GetSchemaKind(member.target->type);
+				if (member.kind == targetKind && ((targetKind & SchemaKind_TypeBit) == 0u || member.typeHash == GetSchemaTypeHash(member.target->type)))
+				{
+					if (member.fixedSize > 0u && member.fixedSize == member.target->fixedSize)
+					{
+						memcpy(member.header, &member.idHash, sizeof(member.idHash));
+						member.headerSize = sizeof(member.idHash) + WriteVarint(member.header + sizeof(member.idHash), member.fixedSize);
+					}
+				}
+				else if (IsArithmeticSchemaKind(member.kind) && IsArithmeticSchemaKind(targetKind))
+				{
+					member.isConverted = true;
+					member.targetKind = targetKind;
+				}
+				else if (member.kind != 0u || (targetKind & SchemaKind_TypeBit) == 0u)
+				{
+					// Values that cannot be read as the new type of the member are left as they are.
+					// Schemas before version 5 give no kind to the values that are not arithmetic, read as before.
+					member.target = nullptr;
+				}
+			}
+			schema.isMapped = true;
+		}
+
+		_plan->readSchema = &schema;
+		_plan->readSchemaGeneration = m_readSchemaGeneration;
+		return &schema;
+	}
+
+	void BinarySerializer::_readSchemaMembers(FDataBuffer* _dataBuffer, const ReadSchema* _schema, uint8_t* _instance)
 	{
-		assert(!m_isReading);
-		assert(!m_isWriting);
+		const std::vector<ReadSchema::Member>& members = _schema->members;
+		size_t memberIndex = 0u;
+		while (_dataBuffer->cursor < _dataBuffer->dataLength)
+		{
+			// Fixed size members of the same type are copied after checking their id and length
+			const uint8_t* bytes = _dataBuffer->data + _dataBuffer->cursor;
+			size_t remainingSize = _dataBuffer->dataLength - _dataBuffer->cursor;
+			if (memberIndex < members.size())
+			{
+				const ReadSchema::Member& member = members[memberIndex];
+				if (member.headerSize > 0u && remainingSize >= member.headerSize + member.fixedSize && memcmp(bytes, member.header, member.headerSize) == 0)
+				{
+					memcpy(_instance + member.target->offset, bytes + member.headerSize, member.fixedSize);
+					_dataBuffer->cursor += member.headerSize + member.fixedSize;
+					++memberIndex;
+					continue;
+				}
+			}
 
-		if (m_writeDataBuffer)
-			_releaseDataBufferToPool(m_writeDataBuffer);
+			uint32_t idHash = 0u;
+			uint64_t payloadSize = 0u;
+			if (!_dataBuffer->read(idHash) || !_dataBuffer->readVarint(payloadSize) || payloadSize > _dataBuffer->dataLength - _dataBuffer->cursor)
+				break;
+			uint8_t* payload = _dataBuffer->data + _dataBuffer->cursor;
+			_dataBuffer->cursor += static_cast<size_t>(payloadSize);
 
-		for (FDataBuffer* dataBuffer : m_dataBufferPool)
-		{
-			delete dataBuffer;
+			// Entries out of the order of the schema are looked up
+			if (memberIndex >= members.size() || members[memberIndex].idHash != idHash)
+			{
+				memberIndex = 0u;
+				while (memberIndex < members.size() && members[memberIndex].idHash != idHash)
+				{
+					++memberIndex;
+				}
+				if (memberIndex == members.size())
+					continue;
+			}
+
+			const ReadSchema::Member& member = members[memberIndex++];
+			if (!member.target)
+				continue;
+
+			if (member.isConverted)
+			{
+				ConvertRawValue(payload, static_cast<size_t>(payloadSize), member.kind, _instance + member.target->offset, member.targetKind);
+			}
+			else
+			{
+				FDataBuffer entryDataBuffer(payload, static_cast<size_t>(payloadSize));
+				_serialize(&entryDataBuffer, _instance + member.target->offset, member.target->type, member.target->metaDataSet);
+			}
 		}
 	}
 
-	void BinarySerializer::beginWrite()
+	void BinarySerializer::_writeNames(const std::vector<const char*>& _names)
 	{
-		assert(!m_isReading);
-		assert(!m_isWriting);
-
-		m_isWriting = true;
+		size_t firstName = _addNames(_names);
+		_writeNamesRecord(firstName, m_writeNames.size() - firstName);
+	}
 
-		if (!m_writeDataBuffer)
+	size_t BinarySerializer::_addNames(const std::vector<const char*>& _names)
+	{
+		size_t firstName = m_writeNames.size();
+		for (const char* name : _names)
 		{
-			m_writeDataBuffer = _getDataBufferFromPool();
+			if (m_writeNameIndices.insert(std::make_pair(name, static_cast<uint32_t>(m_writeNames.size()))).second)
+				m_writeNames.push_back(name);
 		}
-		else
+		return firstName;
+	}
+
+	void BinarySerializer::_writeNamesRecord(size_t _firstName, size_t _nameCount)
+	{
+		if (_nameCount == 0u)
+			return;
+
+		uint8_t record = CompactRecord_Names;
+		m_writeDataBuffer->write(record);
+		m_writeDataBuffer->writeVarint(_nameCount);
+		for (size_t i = _firstName; i < _firstName + _nameCount; ++i)
 		{
-			m_writeDataBuffer->dataLength = 0;
-			m_writeDataBuffer->cursor = 0;
+			_writeString(m_writeDataBuffer, m_writeNames[i], strlen(m_writeNames[i]));
 		}
 	}
 
-	void BinarySerializer::endWrite()
+	bool BinarySerializer::_readNames(FDataBuffer* _dataBuffer)
 	{
-		assert(m_isWriting);
-		m_isWriting = false;
+		uint64_t nameCount = 0u;
+		if (!_dataBuffer->readVarint(nameCount))
+			return false;
+
+		for (uint64_t i = 0; i < nameCount; ++i)
+		{
+			ReadName readName;
+			if (!_readString(_dataBuffer, readName.name))
+				return false;
+			m_readNames.push_back(std::move(readName));
+		}
+		return true;
 	}
 
-	void BinarySerializer::getWriteData(const void*& _outData, size_t& _outDataLength) const
+	void BinarySerializer::_writeNameReference(FDataBuffer* _dataBuffer, const char* _name)
 	{
-		if (m_writeDataBuffer)
+		// Names missing from the table are written inline after a null reference
+		auto it = m_writeNameIndices.find(_name);
+		if (it != m_writeNameIndices.end() && it->second < _dataBuffer->visibleNameCount)
 		{
-			_outData = m_writeDataBuffer->data;
-			_outDataLength = m_writeDataBuffer->dataLength;
+			_dataBuffer->writeVarint(it->second + 1u);
 		}
 		else
 		{
-			_outData = nullptr;
-			_outDataLength = 0u;
+			_dataBuffer->writeVarint(0u);
+			_writeString(_dataBuffer, _name, strlen(_name));
 		}
 	}
 
-	void BinarySerializer::beginRead(const void* _data, size_t _dataLength)
+	const TypeDesc* BinarySerializer::_readClassReference(FDataBuffer* _dataBuffer)
 	{
-		assert(!m_isReading);
-		assert(!m_isWriting);
+		uint64_t reference = 0u;
+		if (!_dataBuffer->readVarint(reference))
+			return nullptr;
 
-		m_readDataBuffer = FDataBuffer(const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(_data)), _dataLength);
-		m_isReading = true;
+		if (reference == 0u)
+		{
+			std::string name;
+			if (!_readString(_dataBuffer, name))
+				return nullptr;
+			return FindTypeByName(name.c_str());
+		}
+
+		if (reference > m_readNames.size())
+			return nullptr;
+
+		ReadName& readName = m_readNames[static_cast<size_t>(reference - 1u)];
+		if (!readName.type)
+			readName.type = FindTypeByName(readName.name.c_str());
+		return readName.type;
 	}
 
-	void BinarySerializer::endRead()
+	void BinarySerializer::_writeString(FDataBuffer* _dataBuffer, const char* _string, size_t _length)
 	{
-		assert(m_isReading);
+		_dataBuffer->writeVarint(_length);
+		_dataBuffer->write(_string, _length);
+	}
 
-		m_readDataBuffer = FDataBuffer();
-		m_isReading = false;
+	bool BinarySerializer::_readString(FDataBuffer* _dataBuffer, std::string& _outString)
+	{
+		const char* string = nullptr;
+		size_t length = 0u;
+		if (!_readStringView(_dataBuffer, string, length))
+			return false;
+
+		_outString.assign(string, length);
+		return true;
 	}
 
-	void BinarySerializer::_serializeEntry(FDataBuffer* _dataBuffer, const char* _id, void* _object, const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet)
+	bool BinarySerializer::_readStringView(FDataBuffer* _dataBuffer, const char*& _outString, size_t& _outLength)
 	{
-		assert(_dataBuffer);
-		assert(_id);
-		assert(_object);
-		assert(_typeDesc);
+		if (m_isReadingCompact)
+		{
+			uint64_t length = 0u;
+			if (!_dataBuffer->readVarint(length) || length > _dataBuffer->dataLength - _dataBuffer->cursor)
+				return false;
 
-		if (m_isWriting)
+			_outString = reinterpret_cast<const char*>(_dataBuffer->data + _dataBuffer->cursor);
+			_outLength = static_cast<size_t>(length);
+			_dataBuffer->cursor += _outLength;
+
+			if (m_isReadingTransientData)
+			{
+				char* copy = reinterpret_cast<char*>(_getViewAllocator()->allocate(_outLength, 1u));
+				memcpy(copy, _outString, _outLength);
+				_outString = copy;
+			}
+		}
+		else
 		{
-			FDataBuffer* entryDataBuffer = _getDataBufferFromPool();
-			_serialize(entryDataBuffer, _object, _typeDesc, _metaDataSet);
+			_outString = reinterpret_cast<const char*>(_dataBuffer->data + _dataBuffer->cursor);
+			const char* stringEnd = reinterpret_cast<const char*>(memchr(_outString, 0, _dataBuffer->dataLength - _dataBuffer->cursor));
+			if (!stringEnd)
+				return false;
+
+			_outLength = stringEnd - _outString;
+			_dataBuffer->cursor += _outLength + 1;
+		}
+		return true;
+	}
 
-			_dataBuffer->write(_id, strlen(_id) + 1);
-			_dataBuffer->write(entryDataBuffer->dataLength);
-			_dataBuffer->write(entryDataBuffer->data, entryDataBuffer->dataLength);
+	Allocator* BinarySerializer::_getViewAllocator()
+	{
+		if (!m_allocator && !m_viewAllocator)
+			m_viewAllocator = new ArenaAllocator();
+
+		return m_allocator ? m_allocator : m_viewAllocator;
+	}
 
-			_releaseDataBufferToPool(entryDataBuffer);
+	void BinarySerializer::_writeEnum(FDataBuffer* _dataBuffer, const void* _object, const Enum* _enum)
+	{
+		// Values without a name are written as a null reference followed by the value
+		int64_t value = GetEnumValue(_enum, _object);
+		const char* name = nullptr;
+		if (!m_writeEnumsAsNumbers && _enum->getStringFromValue(value, name))
+		{
+			auto it = m_writeNameIndices.find(name);
+			if (it != m_writeNameIndices.end() && it->second < _dataBuffer->visibleNameCount)
+			{
+				_dataBuffer->writeVarint(it->second + 1u);
+				return;
+			}
 		}
-		else if (m_isReading)
+
+		_dataBuffer->writeVarint(0u);
+		_dataBuffer->writeVarint(ZigZagEncode(value));
+	}
+
+	void BinarySerializer::_readEnum(FDataBuffer* _dataBuffer, void* _object, const Enum* _enum)
+	{
+		int64_t value = 0;
+		if (m_isReadingCompact)
 		{
-			_dataBuffer->cursor = 0u;
-			while (_dataBuffer->cursor < _dataBuffer->dataLength)
+			uint64_t reference = 0u;
+			if (!_dataBuffer->readVarint(reference))
+				return;
+
+			if (reference == 0u)
+			{
+				uint64_t zigZagValue = 0u;
+				if (!_dataBuffer->readVarint(zigZagValue))
+					return;
+				value = ZigZagDecode(zigZagValue);
+			}
+			else
 			{
-				char* id = (char*)(_dataBuffer->data + _dataBuffer->cursor);
-				_dataBuffer->cursor += strlen(id) + 1;
-				size_t payloadSize = 0u;
-				_dataBuffer->read(payloadSize);
+				if (reference > m_readNames.size())
+					return;
 
-				if (strcmp(_id, id) != 0)
+				ReadName& readName = m_readNames[static_cast<size_t>(reference - 1u)];
+				if (readName.enumType != _enum)
 				{
-					_dataBuffer->cursor += payloadSize;
-					continue;
-				}
-				else
-				{
-					FDataBuffer entryDataBuffer(_dataBuffer->data + _dataBuffer->cursor, payloadSize);
-					_serialize(&entryDataBuffer, _object, _typeDesc, _metaDataSet);
-					break;
+					if (!_enum->getValueFromString(readName.name.c_str(), readName.enumValue))
+						return;
+					readName.enumType = _enum;
 				}
+				value = readName.enumValue;
 			}
 		}
+		else
+		{
+			// Unknown values are written as an empty string, and left untouched when read
+			std::string name;
+			if (!_readString(_dataBuffer, name) || !_enum->getValueFromString(name.c_str(), value))
+				return;
+		}
+
+		SetEnumValue(_enum, _object, value);
+	}
+
+	bool BinarySerializer::_readLength(FDataBuffer* _dataBuffer, size_t& _outLength)
+	{
+		if (m_isReadingCompact)
+		{
+			uint64_t length = 0u;
+			if (!_dataBuffer->readVarint(length) || length > SIZE_MAX)
+				return false;
+			_outLength = static_cast<size_t>(length);
+			return true;
+		}
+		return _dataBuffer->read(_outLength);
 	}
 
 	void BinarySerializer::_serialize(FDataBuffer* _dataBuffer, void* _object, const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet)
@@ -130,6 +3585,9 @@ namespace mirror
 		assert(_object);
 		assert(_typeDesc);
 
+		if (_dataBuffer->hasSinkFailed())
+			return;
+
 		switch (_typeDesc->getType())
 		{
 		case Type_bool:
@@ -171,103 +3629,351 @@ namespace mirror
 		case Type_Enum:
 		{
 			const Enum* enumTypeDesc = static_cast<const Enum*>(_typeDesc);
-
 			if (m_isWriting)
 			{
-				int64_t value;
-				switch (enumTypeDesc->getSubType()->getType())
+				_writeEnum(_dataBuffer, _object, enumTypeDesc);
+			}
+			else if (m_isReading)
+			{
+				_readEnum(_dataBuffer, _object, enumTypeDesc);
+			}
+		}
+		break;
+		case Type_std_string:
+		{
+			std::string* stringPtr = reinterpret_cast<std::string*>(_object);
+			if (m_isWriting)
+			{
+				_writeString(_dataBuffer, stringPtr->data(), stringPtr->length());
+			}
+			else if (m_isReading)
+			{
+				_readString(_dataBuffer, *stringPtr);
+			}
+		}
+		break;
+		case Type_std_string_view:
+		{
+			std::string_view* stringViewPtr = reinterpret_cast<std::string_view*>(_object);
+			if (m_isWriting)
+			{
+				_writeString(_dataBuffer, stringViewPtr->data(), stringViewPtr->size());
+			}
+			else if (m_isReading)
+			{
+				const char* string = nullptr;
+				size_t length = 0u;
+				if (!_readStringView(_dataBuffer, string, length))
+					break;
+
+				if (m_keepViewsInData && m_isReadingDecompressedData && !m_isReadingTransientData)
 				{
-				case Type_int8: value = static_cast<int64_t>(*reinterpret_cast<int8_t*>(_object)); break;
-				case Type_int16: value = static_cast<int64_t>(*reinterpret_cast<int16_t*>(_object)); break;
-				case Type_int32: value = static_cast<int64_t>(*reinterpret_cast<int32_t*>(_object)); break;
-				case Type_int64: value = static_cast<int64_t>(*reinterpret_cast<int64_t*>(_object)); break;
-				default: assert(false); break;
+					*stringViewPtr = std::string_view();
+					m_hasReadFailed = true;
 				}
-
-				const char* str = "";
-				if (enumTypeDesc->getStringFromValue(value, str))
+				else
 				{
-					size_t length = strlen(str);
-					_dataBuffer->write(str, length + 1);
+					*stringViewPtr = std::string_view(string, length);
 				}
 			}
+		}
+		break;
+		case Type_std_span:
+		{
+			// Same layout as a vector of the same values
+			const StdSpanTypeDesc* spanTypeDesc = static_cast<const StdSpanTypeDesc*>(_typeDesc);
+			const RawLayout* rawLayout = _getRawLayout(spanTypeDesc->getSubType());
+			if (m_isWriting)
+			{
+				StdVectorTypeDesc::Span span = spanTypeDesc->instanceGetSpan(_object);
+				_dataBuffer->writeVarint(span.size);
+				if (span.size > 0u)
+					_writeRawBlock(_dataBuffer, rawLayout, span.data, span.size);
+			}
 			else if (m_isReading)
 			{
-				char* str = reinterpret_cast<char*>(_dataBuffer->data + _dataBuffer->cursor);
-				int64_t value;
-				enumTypeDesc->getValueFromString(str, value);
+				size_t spanSize = 0u;
+				uint8_t encoding = ArrayEncoding_Values;
+				if (!_readLength(_dataBuffer, spanSize) || (spanSize > 0u && m_isReadingCompact && !_dataBuffer->read(encoding)))
+					break;
+
+				RawBlock block;
+				if (spanSize == 0u)
+				{
+					spanTypeDesc->instanceSet(_object, nullptr, 0u);
+					break;
+				}
+				else if (encoding == ArrayEncoding_Elements)
+				{
+					// Values written one by one are their raw memory
+					if (spanSize > (_dataBuffer->dataLength - _dataBuffer->cursor) / rawLayout->elementSize)
+						break;
+
+					block.encoding = ArrayEncoding_Values;
+					block.description = rawLayout->description.data();
+					block.descriptionSize = rawLayout->description.size();
+					block.data = _dataBuffer->data + _dataBuffer->cursor;
+					block.elementSize = rawLayout->elementSize;
+					_dataBuffer->cursor += spanSize * rawLayout->elementSize;
+				}
+				else if (!_readRawBlock(_dataBuffer, encoding, spanSize, block))
+				{
+					break;
+				}
 
-				switch (enumTypeDesc->getSubType()->getType())
+				const void* data = block.data;
+				bool isSameLayout = block.descriptionSize == rawLayout->description.size() && memcmp(block.description, rawLayout->description.data(), block.descriptionSize) == 0;
+				bool isCopied = !isSameLayout || reinterpret_cast<uintptr_t>(data) % rawLayout->elementAlignment != 0u || m_isReadingTransientData;
+				if (m_keepViewsInData && !m_isReadingTransientData && (isCopied || m_isReadingDecompressedData))
 				{
-				case Type_int8: *reinterpret_cast<int8_t*>(_object) = static_cast<int8_t>(value); break;
-				case Type_int16: *reinterpret_cast<int16_t*>(_object) = static_cast<int16_t>(value); break;
-				case Type_int32: *reinterpret_cast<int32_t*>(_object) = static_cast<int32_t>(value); break;
-				case Type_int64: *reinterpret_cast<int64_t*>(_object) = static_cast<int64_t>(value); break;
+					spanTypeDesc->instanceSet(_object, nullptr, 0u);
+					m_hasReadFailed = true;
+					break;
+				}
+				if (isCopied)
+				{
+					Allocator* allocator = _getViewAllocator();
+					size_t byteSize = spanSize * rawLayout->elementSize;
+					uint8_t* copy = reinterpret_cast<uint8_t*>(allocator->allocate(byteSize, rawLayout->elementAlignment));
+					memset(copy, 0, byteSize);
+					_copyRawBlock(block, rawLayout, spanSize, copy);
+					data = copy;
 				}
+				spanTypeDesc->instanceSet(_object, data, spanSize);
 			}
 		}
 		break;
-		case Type_std_string:
+		case Type_std_vector:
 		{
-			std::string* stringPtr = reinterpret_cast<std::string*>(_object);
+			const StdVectorTypeDesc* vectorTypeDesc = static_cast<const StdVectorTypeDesc*>(_typeDesc);
+			const TypeDesc* subType = vectorTypeDesc->getSubType();
+			const RawLayout* rawLayout = _getRawLayout(subType);
 			if (m_isWriting)
 			{
-				_dataBuffer->write(stringPtr->data(), stringPtr->length() + 1);
+				// Non empty vectors are followed by their encoding
+				StdVectorTypeDesc::Span span = vectorTypeDesc->instanceGetSpan(_object);
+				_dataBuffer->writeVarint(span.size);
+				if (span.size == 0u)
+					break;
+
+				if (_canWriteRaw(rawLayout))
+				{
+					_writeRawBlock(_dataBuffer, rawLayout, span.data, span.size);
+					break;
+				}
+
+				uint8_t encoding = ArrayEncoding_Elements;
+				_dataBuffer->write(encoding);
+				for (size_t i = 0; i < span.size && !_dataBuffer->hasSinkFailed(); ++i)
+				{
+					_serialize(_dataBuffer, span.at(i), subType);
+				}
 			}
 			else if (m_isReading)
 			{
-				*stringPtr = reinterpret_cast<char *>(_dataBuffer->data + _dataBuffer->cursor);
+				size_t vectorSize = 0u;
+				uint8_t encoding = ArrayEncoding_Elements;
+				if (!_readLength(_dataBuffer, vectorSize) || (vectorSize > 0u && m_isReadingCompact && !_dataBuffer->read(encoding)))
+					break;
+
+				if (encoding == ArrayEncoding_Delta)
+				{
+					// Elements of the baseline are kept, then the runs of elements that changed are read over them
+					vectorTypeDesc->instanceResize(_object, vectorSize);
+					StdVectorTypeDesc::Span span = vectorTypeDesc->instanceGetSpan(_object);
+					size_t index = 0u;
+					uint64_t gap = 0u;
+					while (_dataBuffer->readVarint(gap) && gap > 0u)
+					{
+						size_t runLength = 0u;
+						if (gap - 1u > span.size - index || !_readLength(_dataBuffer, runLength) || runLength > _dataBuffer->dataLength - _dataBuffer->cursor)
+							break;
+
+						index += static_cast<size_t>(gap - 1u);
+						FDataBuffer runDataBuffer(_dataBuffer->data + _dataBuffer->cursor, runLength);
+						while (runDataBuffer.cursor < runDataBuffer.dataLength && index < span.size)
+						{
+							_serialize(&runDataBuffer, span.at(index++), subType);
+						}
+						_dataBuffer->cursor += runLength;
+					}
+					break;
+				}
+
+				if (encoding != ArrayEncoding_Elements)
+				{
+					RawBlock block;
+					if (!_readRawBlock(_dataBuffer, encoding, vectorSize, block))
+						break;
+
+					vectorTypeDesc->instanceResize(_object, vectorSize);
+					_copyRawBlock(block, rawLayout, vectorSize, reinterpret_cast<uint8_t*>(vectorTypeDesc->instanceGetSpan(_object).data));
+					break;
+				}
+
+				// Elements take at least a byte each
+				if (vectorSize > _dataBuffer->dataLength - _dataBuffer->cursor)
+					break;
+
+				vectorTypeDesc->instanceResize(_object, vectorSize);
+				StdVectorTypeDesc::Span span = vectorTypeDesc->instanceGetSpan(_object);
+				for (size_t i = 0; i < span.size; ++i)
+				{
+					_serialize(_dataBuffer, span.at(i), subType);
+				}
 			}
 		}
 		break;
-		case Type_std_vector:
+		case Type_std_pair:
 		{
-			const StdVectorTypeDesc* vectorTypeDesc = static_cast<const StdVectorTypeDesc*>(_typeDesc);
-			size_t vectorSize = 0u;
+			const StdPairTypeDesc* pairTypeDesc = static_cast<const StdPairTypeDesc*>(_typeDesc);
+			_serialize(_dataBuffer, pairTypeDesc->instanceGetFirst(_object), pairTypeDesc->getFirstType());
+			_serialize(_dataBuffer, pairTypeDesc->instanceGetSecond(_object), pairTypeDesc->getSecondType());
+		}
+		break;
+		case Type_std_optional:
+		{
+			const StdOptionalTypeDesc* optionalTypeDesc = static_cast<const StdOptionalTypeDesc*>(_typeDesc);
+			bool hasValue = false;
 			if (m_isWriting)
 			{
-				vectorSize = vectorTypeDesc->instanceSize(_object);
-				_dataBuffer->write(vectorSize);
+				void* value = optionalTypeDesc->instanceGetValue(_object);
+				hasValue = value != nullptr;
+				_dataBuffer->write(hasValue);
+				if (hasValue)
+				{
+					_serialize(_dataBuffer, value, optionalTypeDesc->getSubType());
+				}
 			}
 			else if (m_isReading)
 			{
-				_dataBuffer->read(vectorSize);
-				vectorTypeDesc->instanceResize(_object, vectorSize);
+				// Read as a byte, a bool holding anything else than 0 or 1 being undefined
+				uint8_t hasValueByte = 0u;
+				if (!_dataBuffer->read(hasValueByte) || hasValueByte > 1u)
+					break;
+				hasValue = hasValueByte != 0u;
+				if (hasValue)
+				{
+					_serialize(_dataBuffer, optionalTypeDesc->instanceEmplace(_object), optionalTypeDesc->getSubType());
+				}
+				else
+				{
+					optionalTypeDesc->instanceReset(_object);
+				}
+			}
+		}
+		break;
+		case Type_std_unique_ptr:
+		{
+			const StdUniquePtrTypeDesc* uniquePtrTypeDesc = static_cast<const StdUniquePtrTypeDesc*>(_typeDesc);
+			const TypeDesc* subType = uniquePtrTypeDesc->getSubType();
+			if (subType->hasFactory())
+			{
+				if (m_isWriting)
+				{
+					_writeOwnedObject(_dataBuffer, uniquePtrTypeDesc->instanceGet(_object), subType);
+				}
+				else if (m_isReading)
+				{
+					// A unique_ptr cannot share its object, references are read as null. Its deleter uses delete, so the object is created with new.
+					uniquePtrTypeDesc->instanceReset(_object, _readOwnedObject(_dataBuffer, subType, nullptr, nullptr));
+				}
+			}
+		}
+		break;
+		case Type_std_map:
+		case Type_std_unordered_map:
+		{
+			const StdMapTypeDesc* mapTypeDesc = static_cast<const StdMapTypeDesc*>(_typeDesc);
+			const TypeDesc* keyType = mapTypeDesc->getKeyType();
+			const TypeDesc* valueType = mapTypeDesc->getValueType();
+			size_t mapSize = 0u;
+			if (m_isWriting)
+			{
+				std::vector<StdMapTypeDesc::Entry> entries;
+				mapTypeDesc->instanceGetEntries(_object, entries);
+				mapSize = entries.size();
+				_dataBuffer->writeVarint(mapSize);
+				for (size_t i = 0; i < mapSize && !_dataBuffer->hasSinkFailed(); ++i)
+				{
+					_serialize(_dataBuffer, const_cast<void*>(entries[i].key), keyType);
+					_serialize(_dataBuffer, entries[i].value, valueType);
+				}
 			}
-			for (size_t i = 0; i < vectorSize; ++i)
+			else if (m_isReading)
 			{
-				_serialize(_dataBuffer, vectorTypeDesc->instanceGetDataPointerAt(_object, i), vectorTypeDesc->getSubType());
+				// Entries take at least a byte each
+				if (!_readLength(_dataBuffer, mapSize) || mapSize > _dataBuffer->dataLength - _dataBuffer->cursor)
+					break;
+				mapTypeDesc->instanceClear(_object);
+				mapTypeDesc->instanceReserve(_object, mapSize);
+				void* key = mapTypeDesc->newKey();
+				for (size_t i = 0; i < mapSize; ++i)
+				{
+					// Stops at the end of the data, or at an entry that could not be read
+					size_t cursor = _dataBuffer->cursor;
+					_serialize(_dataBuffer, key, keyType);
+					if (_dataBuffer->cursor == cursor)
+						break;
+					_serialize(_dataBuffer, mapTypeDesc->instanceInsert(_object, key), valueType);
+				}
+				mapTypeDesc->deleteKey(key);
 			}
-		}	
+		}
 		break;
 		case Type_Class:
 		{
 			const Class* clss = static_cast<const Class*>(_typeDesc);
+			if (!m_useClassPlans)
+			{
+				_serializeMembers(_dataBuffer, clss, _object);
+				break;
+			}
+
+			const ClassPlan* plan = _getClassPlan(clss);
+			uint8_t* instance = reinterpret_cast<uint8_t*>(_object);
 
 			if (m_isWriting)
 			{
-				FDataBuffer* instanceDataBuffer = _getDataBufferFromPool();
-				std::vector<mirror::ClassMember*> members;
-				clss->getMembers(members);
-				for (const ClassMember* member : members)
+				size_t lengthPosition = _dataBuffer->reserveLength();
+				for (const ClassPlan::Run& run : plan->runs)
 				{
-					_serializeEntry(instanceDataBuffer, member->getName(), member->getInstanceMemberPointer(_object), member->getType(), &member->GetMetaDataSet());
+					if (run.entriesTemplate.empty())
+					{
+						const ClassPlan::Member& member = plan->members[run.firstMember];
+						_dataBuffer->write(member.idHash);
+						size_t memberLengthPosition = _dataBuffer->reserveLength();
+						_serialize(_dataBuffer, instance + member.offset, member.type, member.metaDataSet);
+						_dataBuffer->patchLength(memberLengthPosition);
+					}
+					else if (_dataBuffer->isCounting())
+					{
+						_dataBuffer->cursor += run.entriesTemplate.size();
+					}
+					else
+					{
+						uint8_t* entries = _dataBuffer->allocate(run.entriesTemplate.size());
+						memcpy(entries, run.entriesTemplate.data(), run.entriesTemplate.size());
+						for (size_t i = 0; i < run.memberCount; ++i)
+						{
+							const ClassPlan::Member& member = plan->members[run.firstMember + i];
+							memcpy(entries + run.payloadOffsets[i], instance + member.offset, member.fixedSize);
+						}
+					}
 				}
-				_dataBuffer->write(instanceDataBuffer->dataLength);
-				_dataBuffer->write(instanceDataBuffer->data, instanceDataBuffer->dataLength);
-				_releaseDataBufferToPool(instanceDataBuffer);
+				_dataBuffer->patchLength(lengthPosition);
 			}
 			else
 			{
 				size_t dataLength = 0u;
-				_dataBuffer->read(dataLength);
+				if (!_readLength(_dataBuffer, dataLength) || dataLength > _dataBuffer->dataLength - _dataBuffer->cursor)
+					break;
 				FDataBuffer instanceDataBuffer = FDataBuffer(_dataBuffer->data + _dataBuffer->cursor, dataLength);
-				std::vector<mirror::ClassMember*> members;
-				clss->getMembers(members);
-				for (const ClassMember* member : members)
-				{
-					_serializeEntry(&instanceDataBuffer, member->getName(), member->getInstanceMemberPointer(_object), member->getType(), &member->GetMetaDataSet());
-				}
+				const ReadSchema* schema = m_isReadingCompact ? _getReadSchema(plan) : nullptr;
+				if (schema)
+					_readSchemaMembers(&instanceDataBuffer, schema, instance);
+				else
+					_readMembers(&instanceDataBuffer, plan, instance);
 				_dataBuffer->cursor += dataLength;
 			}
 		}
@@ -281,51 +3987,24 @@ namespace mirror
 				if (subType->hasFactory())
 				{
 					void** pointerPtr = reinterpret_cast<void**>(_object);
-					bool isValidPointer;
 					if (m_isWriting)
 					{
-						isValidPointer = *pointerPtr != nullptr;
-						_dataBuffer->write(isValidPointer);
-						if (isValidPointer)
-						{
-							if (subType->getType() == Type_Class)
-							{
-								subType = reinterpret_cast<const Class*>(subType)->unsafeVirtualGetClass(*pointerPtr);
-								std::string className = subType->getName();
-								_dataBuffer->write(className);
-							}
-							_serialize(_dataBuffer, *pointerPtr, subType, nullptr);
-						}
+						_writeOwnedObject(_dataBuffer, *pointerPtr, subType);
 					}
 					else if (m_isReading)
 					{
 						// @TODO(2021/02/15|Remi): May leak the previous value of the pointer. What should we do ? Whose responsibility is it ?
-						// This is also probably related to the custom allocator subject
-
-						_dataBuffer->read(isValidPointer);
-						if (isValidPointer)
-						{
-							if (subType->getType() == Type_Class)
-							{
-								std::string className;
-								_dataBuffer->read(className);
-								subType = mirror::FindTypeByName(className.c_str());
-								assert(subType);
-							}
-
-							*pointerPtr = subType->instantiate();
-							_serialize(_dataBuffer, *pointerPtr, subType, nullptr);
-						}
-						else
-						{
-							*pointerPtr = nullptr;
-						}
+						*pointerPtr = _readOwnedObject(_dataBuffer, subType, m_allocator, pointerPtr);
 					}
 				}
 			}
 			else
 			{
-				// @TODO(2021/02/15|Remi): Linkage with other pointers of this serialization
+				void** pointerPtr = reinterpret_cast<void**>(_object);
+				if (m_isWriting)
+					_writePointer(_dataBuffer, *pointerPtr);
+				else if (m_isReading && m_isReadingCompact && m_readVersion >= 2u)
+					_readPointer(_dataBuffer, pointerPtr);
 			}
 		}
 		break;
@@ -333,7 +4012,45 @@ namespace mirror
 		{
 			const FixedSizeArrayTypeDesc* fixedSizeArrayTypeDesc = static_cast<const FixedSizeArrayTypeDesc*>(_typeDesc);
 			const TypeDesc* subType = fixedSizeArrayTypeDesc->getSubType();
-			for (size_t i = 0; i < fixedSizeArrayTypeDesc->getElementCount(); ++i)
+			size_t elementCount = fixedSizeArrayTypeDesc->getElementCount();
+
+			// Arrays of arithmetic values are their raw memory in all formats
+			size_t fixedPayloadSize = GetFixedPayloadSize(_typeDesc);
+			if (fixedPayloadSize > 0u)
+			{
+				if (m_isWriting)
+					_dataBuffer->write(_object, fixedPayloadSize);
+				else if (m_isReading)
+					_dataBuffer->read(_object, fixedPayloadSize);
+				break;
+			}
+
+			const RawLayout* rawLayout = _getRawLayout(subType);
+			uint8_t encoding = ArrayEncoding_Elements;
+			if (m_isWriting)
+			{
+				if (_canWriteRaw(rawLayout))
+				{
+					_writeRawBlock(_dataBuffer, rawLayout, _object, elementCount);
+					break;
+				}
+				_dataBuffer->write(encoding);
+			}
+			else if (m_isReadingCompact)
+			{
+				if (!_dataBuffer->read(encoding))
+					break;
+
+				if (encoding != ArrayEncoding_Elements)
+				{
+					RawBlock block;
+					if (_readRawBlock(_dataBuffer, encoding, elementCount, block))
+						_copyRawBlock(block, rawLayout, elementCount, reinterpret_cast<uint8_t*>(_object));
+					break;
+				}
+			}
+
+			for (size_t i = 0; i < elementCount; ++i)
 			{
 				_serialize(_dataBuffer, (uint8_t*)(_object) + i * subType->getSize(), subType, nullptr);
 			}
@@ -344,18 +4061,269 @@ namespace mirror
 		}
 	}
 
-	mirror::BinarySerializer::FDataBuffer* BinarySerializer::_getDataBufferFromPool()
+	void BinarySerializer::_writeOwnedObject(FDataBuffer* _dataBuffer, void* _object, const TypeDesc* _subType)
 	{
-		if (m_dataBufferPool.empty())
+		uint8_t tag = _object ? PointerTag_Object : PointerTag_Null;
+		if (_object && m_isWritingObjects)
 		{
-			return new FDataBuffer();
+			// Ordinals are given before the payload is written, so that the objects it reaches can refer back to it
+			auto result = m_writeObjectOrdinals.insert(std::make_pair(_object, m_writeObjectCount));
+			size_t ordinal = result.first->second;
+			if (ordinal < m_writeObjectCount)
+			{
+				tag = PointerTag_Reference;
+				_dataBuffer->write(tag);
+				_dataBuffer->writeVarint(ordinal);
+				return;
+			}
+
+			++m_writeObjectCount;
+			tag = PointerTag_IdentifiedObject;
+			_dataBuffer->write(tag);
+			_dataBuffer->writeVarint(ordinal);
 		}
 		else
 		{
-			FDataBuffer* dataBuffer = *(m_dataBufferPool.rbegin());
-			m_dataBufferPool.pop_back();
-			return dataBuffer;
+			_dataBuffer->write(tag);
+		}
+
+		if (_object)
+		{
+			if (_subType->getType() == Type_Class)
+			{
+				_subType = reinterpret_cast<const Class*>(_subType)->unsafeVirtualGetClass(_object);
+				_writeNameReference(_dataBuffer, _subType->getName());
+			}
+			_serialize(_dataBuffer, _object, _subType, nullptr);
+		}
+	}
+
+	void* BinarySerializer::_readOwnedObject(FDataBuffer* _dataBuffer, const TypeDesc* _subType, Allocator* _allocator, void** _pointer)
+	{
+		uint8_t tag = PointerTag_Null;
+		uint64_t ordinal = 0u;
+		_dataBuffer->read(tag);
+		if (tag == PointerTag_Reference && m_isReadingCompact)
+		{
+			if (_pointer && _dataBuffer->readVarint(ordinal))
+				m_readObjectReferences.push_back(std::make_pair(_pointer, static_cast<size_t>(ordinal)));
+			return nullptr;
+		}
+		if (tag == PointerTag_IdentifiedObject && m_isReadingCompact)
+		{
+			if (!_dataBuffer->readVarint(ordinal))
+				return nullptr;
+		}
+		else if (tag != PointerTag_Object)
+		{
+			return nullptr;
+		}
+
+		if (_subType->getType() == Type_Class)
+		{
+			if (m_isReadingCompact)
+			{
+				_subType = _readClassReference(_dataBuffer);
+			}
+			else
+			{
+				std::string className;
+				_dataBuffer->read(className);
+				_subType = mirror::FindTypeByName(className.c_str());
+			}
+			assert(_subType);
+			if (!_subType)
+				return nullptr;
+		}
+
+		void* object = _subType->instantiate(_allocator);
+		if (tag == PointerTag_IdentifiedObject)
+			m_readObjects[static_cast<size_t>(ordinal)] = object;
+		_serialize(_dataBuffer, object, _subType, nullptr);
+		return object;
+	}
+
+	void BinarySerializer::_writePointer(FDataBuffer* _dataBuffer, const void* _object)
+	{
+		assert(m_isWritingObjects);
+
+		// Objects that are not owned by a pointer of the entry are not written
+		auto it = _object ? m_writeObjectOrdinals.find(_object) : m_writeObjectOrdinals.end();
+		uint8_t tag = it != m_writeObjectOrdinals.end() ? PointerTag_Reference : PointerTag_Null;
+		_dataBuffer->write(tag);
+		if (tag == PointerTag_Reference)
+			_dataBuffer->writeVarint(it->second);
+	}
+
+	void BinarySerializer::_readPointer(FDataBuffer* _dataBuffer, void** _pointer)
+	{
+		*_pointer = nullptr;
+
+		uint8_t tag = PointerTag_Null;
+		uint64_t ordinal = 0u;
+		if (_dataBuffer->read(tag) && tag == PointerTag_Reference && _dataBuffer->readVarint(ordinal))
+			m_readObjectReferences.push_back(std::make_pair(_pointer, static_cast<size_t>(ordinal)));
+	}
+
+	// Kinds of raw pointers and views a value may hold. Classes behind owned pointers add the ones of their children.
+	static uint8_t CollectPointerFlags(const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet, bool _isOwned, std::unordered_set<const TypeDesc*>& _visitedTypes)
+	{
+		if (!_typeDesc)
+			return 0u;
+
+		uint8_t flags = 0u;
+		if (_isOwned && _typeDesc->getType() == Type_Class)
+		{
+			for (const Class* child : static_cast<const Class*>(_typeDesc)->getChildren())
+			{
+				flags |= CollectPointerFlags(child, nullptr, true, _visitedTypes);
+			}
+		}
+
+		// Depends on the meta data of the member, so checked each time
+		if (_typeDesc->getType() == Type_Pointer)
+		{
+			if (!_metaDataSet || !_metaDataSet->findMetaData("OwnedPointer"))
+				return flags | PointerFlag_Pointer;
+			return flags | PointerFlag_OwnedPointer | CollectPointerFlags(static_cast<const PointerTypeDesc*>(_typeDesc)->getSubType(), nullptr, true, _visitedTypes);
+		}
+
+		if (!_visitedTypes.insert(_typeDesc).second)
+			return flags;
+
+		switch (_typeDesc->getType())
+		{
+		case Type_std_string_view:
+		case Type_std_span:
+			flags |= PointerFlag_View;
+			break;
+		case Type_Class:
+		{
+			std::vector<ClassMember*> members;
+			static_cast<const Class*>(_typeDesc)->getMembers(members);
+			for (const ClassMember* member : members)
+			{
+				flags |= CollectPointerFlags(member->getType(), &member->GetMetaDataSet(), false, _visitedTypes);
+			}
+		}
+		break;
+		case Type_std_unique_ptr:
+			flags |= CollectPointerFlags(static_cast<const StdUniquePtrTypeDesc*>(_typeDesc)->getSubType(), nullptr, true, _visitedTypes);
+			break;
+		case Type_std_vector:
+			flags |= CollectPointerFlags(static_cast<const StdVectorTypeDesc*>(_typeDesc)->getSubType(), nullptr, false, _visitedTypes);
+			break;
+		case Type_std_optional:
+			flags |= CollectPointerFlags(static_cast<const StdOptionalTypeDesc*>(_typeDesc)->getSubType(), nullptr, false, _visitedTypes);
+			break;
+		case Type_FixedSizeArray:
+			flags |= CollectPointerFlags(static_cast<const FixedSizeArrayTypeDesc*>(_typeDesc)->getSubType(), nullptr, false, _visitedTypes);
+			break;
+		case Type_std_pair:
+			flags |= CollectPointerFlags(static_cast<const StdPairTypeDesc*>(_typeDesc)->getFirstType(), nullptr, false, _visitedTypes);
+			flags |= CollectPointerFlags(static_cast<const StdPairTypeDesc*>(_typeDesc)->getSecondType(), nullptr, false, _visitedTypes);
+			break;
+		case Type_std_map:
+		case Type_std_unordered_map:
+			flags |= CollectPointerFlags(static_cast<const StdMapTypeDesc*>(_typeDesc)->getKeyType(), nullptr, false, _visitedTypes);
+			flags |= CollectPointerFlags(static_cast<const StdMapTypeDesc*>(_typeDesc)->getValueType(), nullptr, false, _visitedTypes);
+			break;
+		default:
+			break;
+		}
+		return flags;
+	}
+
+	uint8_t BinarySerializer::_getPointerFlags(const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet)
+	{
+		std::unordered_set<const TypeDesc*> visitedTypes;
+		if (_typeDesc->getType() == Type_Pointer)
+			return CollectPointerFlags(_typeDesc, _metaDataSet, false, visitedTypes);
+
+		auto it = m_pointerFlags.find(_typeDesc);
+		if (it != m_pointerFlags.end())
+			return it->second;
+
+		uint8_t flags = CollectPointerFlags(_typeDesc, nullptr, false, visitedTypes);
+		m_pointerFlags.insert(std::make_pair(_typeDesc, flags));
+		return flags;
+	}
+
+	bool BinarySerializer::holdsViews(const TypeDesc* _typeDesc)
+	{
+		return (_getPointerFlags(_typeDesc, nullptr) & PointerFlag_View) != 0u;
+	}
+
+	void BinarySerializer::_beginWriteObjects(void* _object, const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet)
+	{
+		m_writeObjectOrdinals.clear();
+		m_writeObjectCount = 0u;
+
+		// Without raw pointers, objects cannot be reached twice
+		uint8_t flags = _getPointerFlags(_typeDesc, _metaDataSet);
+		m_isWritingObjects = (flags & PointerFlag_AnyPointer) != 0u;
+		if ((flags & PointerFlag_Pointer) == 0u)
+			return;
+
+		m_measureStream = FLengthStream();
+		m_measureStream.isCounting = true;
+		m_measureStream.chunkSize = SIZE_MAX;
+		m_measureDataBuffer.baseOffset = 0u;
+		m_measureDataBuffer.cursor = 0u;
+		m_measureDataBuffer.dataLength = 0u;
+		m_measureDataBuffer.stream = &m_measureStream;
+		_serialize(&m_measureDataBuffer, _object, _typeDesc, _metaDataSet);
+		m_writeObjectCount = 0u;
+	}
+
+	void BinarySerializer::_endWriteObjects()
+	{
+		m_writeObjectOrdinals.clear();
+		m_writeObjectCount = 0u;
+		m_isWritingObjects = false;
+	}
+
+	void BinarySerializer::_endReadObjects()
+	{
+		for (const std::pair<void**, size_t>& reference : m_readObjectReferences)
+		{
+			auto it = m_readObjects.find(reference.second);
+			*reference.first = it != m_readObjects.end() ? it->second : nullptr;
+		}
+		m_readObjectReferences.clear();
+		m_readObjects.clear();
+	}
+
+	BinarySerializer& BinarySerializer::GetThreadSerializer()
+	{
+		static thread_local BinarySerializer s_threadSerializer;
+		return s_threadSerializer;
+	}
+
+	BinarySerializer::DataBufferSlot BinarySerializer::s_dataBufferPool[BinarySerializer::DataBufferPoolSize];
+
+	// First slot tried by the calling thread, so that threads mostly use different slots
+	static size_t GetDataBufferPoolStart()
+	{
+		static std::atomic<size_t> s_nextStart{ 0u };
+		static thread_local size_t s_start = s_nextStart.fetch_add(1u, std::memory_order_relaxed);
+		return s_start;
+	}
+
+	mirror::BinarySerializer::FDataBuffer* BinarySerializer::_getDataBufferFromPool()
+	{
+		size_t start = GetDataBufferPoolStart();
+		for (size_t i = 0; i < DataBufferPoolSize; ++i)
+		{
+			std::atomic<FDataBuffer*>& slot = s_dataBufferPool[(start + i) % DataBufferPoolSize].dataBuffer;
+			if (slot.load(std::memory_order_relaxed) == nullptr)
+				continue;
+
+			FDataBuffer* dataBuffer = slot.exchange(nullptr, std::memory_order_acquire);
+			if (dataBuffer)
+				return dataBuffer;
 		}
+		return new FDataBuffer();
 	}
 
 	void BinarySerializer::_releaseDataBufferToPool(FDataBuffer* _dataBuffer)
@@ -363,9 +4331,21 @@ namespace mirror
 		assert(_dataBuffer);
 		assert(_dataBuffer->isOwningData);
 
+		_dataBuffer->resetSegments();
 		_dataBuffer->cursor = 0;
 		_dataBuffer->dataLength = 0;
-		m_dataBufferPool.push_back(_dataBuffer);
+		_dataBuffer->baseOffset = 0u;
+		_dataBuffer->stream = nullptr;
+
+		size_t start = GetDataBufferPoolStart();
+		for (size_t i = 0; i < DataBufferPoolSize; ++i)
+		{
+			std::atomic<FDataBuffer*>& slot = s_dataBufferPool[(start + i) % DataBufferPoolSize].dataBuffer;
+			FDataBuffer* empty = nullptr;
+			if (slot.load(std::memory_order_relaxed) == nullptr && slot.compare_exchange_strong(empty, _dataBuffer, std::memory_order_release, std::memory_order_relaxed))
+				return;
+		}
+		delete _dataBuffer;
 	}
 
 	BinarySerializer::FDataBuffer::FDataBuffer()
@@ -384,21 +4364,292 @@ namespace mirror
 	{
 		if (isOwningData)
 		{
+			resetSegments();
+			for (const Segment& segment : spareSegments)
+			{
+				free(segment.data);
+			}
 			free(data);
 		}
 	}
 
 	void BinarySerializer::FDataBuffer::write(const void* _data, size_t _size)
+	{
+		if (stream)
+		{
+			if (stream->isCounting)
+			{
+				cursor += _size;
+				return;
+			}
+
+			// Large data whose lengths are all written goes to the sink from where it is, along with the buffered bytes
+			if (_size >= stream->chunkSize && !stream->hasSinkFailed
+				&& std::all_of(stream->openSlots.begin(), stream->openSlots.end(), [](const FLengthStream::Slot& _slot) { return _slot.isKnown; }))
+			{
+				OutputSegment segments[2] = { { data, cursor }, { _data, _size } };
+				stream->hasSinkFailed = !stream->sink->write(segments, 2);
+				baseOffset += cursor + _size;
+				cursor = 0u;
+				dataLength = 0u;
+				return;
+			}
+		}
+
+		memcpy(allocate(_size), _data, _size);
+
+		if (stream && cursor >= stream->chunkSize)
+			flush();
+	}
+
+	uint8_t* BinarySerializer::FDataBuffer::allocate(size_t _size)
 	{
 		assert(isOwningData);
 
+		if (stream && stream->isCounting)
+		{
+			// The caller writes to scratch memory
+			if (stream->scratch.size() < _size)
+				stream->scratch.resize(_size);
+			cursor += _size;
+			return stream->scratch.data();
+		}
+
 		if (cursor + _size > dataAllocatedSize)
 			reserve(cursor + _size);
 
-		memcpy(data + cursor, _data, _size);
+		uint8_t* bytes = data + cursor;
 		cursor += _size;
 		if (dataLength < cursor)
 			dataLength = cursor;
+		return bytes;
+	}
+
+	void BinarySerializer::FDataBuffer::writeVarint(uint64_t _value)
+	{
+		uint8_t bytes[10];
+		write(bytes, WriteVarint(bytes, _value));
+	}
+
+	size_t BinarySerializer::FDataBuffer::reserveLength()
+	{
+		size_t lengthPosition = baseOffset + cursor;
+		if (stream)
+		{
+			FLengthStream::Slot slot;
+			slot.position = lengthPosition;
+			slot.ordinal = stream->ordinal++;
+			slot.knownLength = 0u;
+			slot.isKnown = stream->nextKnownLength < stream->knownLengths.size() && stream->knownLengths[stream->nextKnownLength].first == slot.ordinal;
+			stream->openSlots.push_back(slot);
+
+			if (slot.isKnown)
+			{
+				// Written as patchLength would, so that the output is the same as in memory
+				slot.knownLength = stream->knownLengths[stream->nextKnownLength++].second;
+				stream->openSlots.back().knownLength = slot.knownLength;
+				size_t lengthSize = GetVarintSize(slot.knownLength);
+				if (lengthSize <= PaddedLengthSize)
+				{
+					WritePaddedVarint(allocate(PaddedLengthSize), slot.knownLength, PaddedLengthSize);
+				}
+				else
+				{
+					WriteVarint(allocate(lengthSize), slot.knownLength);
+					stream->openExtraLengthSize += lengthSize - PaddedLengthSize;
+				}
+				return lengthPosition;
+			}
+
+			if (!stream->isCounting && cursor >= stream->chunkSize)
+				flush();
+			// Nothing reaches the sink while measuring, it is asked from time to time whether writing it still makes sense
+			else if (stream->isCounting && stream->sink && (slot.ordinal & 1023u) == 0u && stream->sink->hasFailed())
+				stream->hasSinkFailed = true;
+		}
+
+		allocate(PaddedLengthSize);
+		return lengthPosition;
+	}
+
+	size_t BinarySerializer::FDataBuffer::patchLength(size_t _lengthPosition)
+	{
+		assert(isOwningData);
+		assert(_lengthPosition + PaddedLengthSize <= baseOffset + cursor);
+
+		size_t dataPosition = _lengthPosition + PaddedLengthSize;
+		size_t length = baseOffset + cursor - dataPosition;
+		size_t lengthSize = GetVarintSize(length);
+
+		if (stream)
+		{
+			FLengthStream::Slot slot = stream->openSlots.back();
+			stream->openSlots.pop_back();
+			assert(slot.position == _lengthPosition);
+
+			if (slot.isKnown)
+			{
+				if (GetVarintSize(slot.knownLength) > PaddedLengthSize)
+					stream->openExtraLengthSize -= GetVarintSize(slot.knownLength) - PaddedLengthSize;
+				// Encoding stops early once the sink failed
+				assert(stream->hasSinkFailed || baseOffset + cursor == _lengthPosition + std::max(GetVarintSize(slot.knownLength), PaddedLengthSize) + slot.knownLength);
+				return 0u;
+			}
+
+			if (stream->isCounting)
+			{
+				// The padding counted since the length was reserved differs by residue, up to maxResiduePadding
+				if (stream->residueCount > 0u && GetVarintSize(length + stream->maxResiduePadding) != lengthSize)
+					stream->hasResidueFailed = true;
+				if (lengthSize > PaddedLengthSize)
+					cursor += lengthSize - PaddedLengthSize;
+				if (length >= stream->chunkSize)
+					stream->knownLengths.push_back(std::make_pair(slot.ordinal, length));
+				return 0u;
+			}
+		}
+
+		assert(_lengthPosition >= baseOffset);
+		size_t lengthOffset = _lengthPosition - baseOffset;
+		size_t shift = 0u;
+		if (lengthSize <= PaddedLengthSize)
+		{
+			WritePaddedVarint(data + lengthOffset, length, PaddedLengthSize);
+		}
+		else
+		{
+			// Makes room for the longer varint
+			shift = lengthSize - PaddedLengthSize;
+			allocate(shift);
+			memmove(data + lengthOffset + PaddedLengthSize + shift, data + lengthOffset + PaddedLengthSize, length);
+			WriteVarint(data + lengthOffset, length);
+		}
+
+		if (stream && cursor >= stream->chunkSize)
+			flush();
+		return shift;
+	}
+
+	void BinarySerializer::FDataBuffer::writePadding(size_t _alignment)
+	{
+		if (stream && stream->residueCount > 0u)
+		{
+			// Counted for each start position, the padding byte being the same for all
+			if (stream->residueCount % _alignment != 0u)
+				stream->hasResidueFailed = true;
+
+			// Alignments are powers of two
+			size_t mask = _alignment - 1u;
+			for (size_t residue = 0; mask > 0u && residue < stream->residueCount; ++residue)
+			{
+				size_t position = residue + baseOffset + cursor + stream->residuePaddings[residue] + 1u;
+				stream->residuePaddings[residue] += (_alignment - (position & mask)) & mask;
+				stream->maxResiduePadding = std::max(stream->maxResiduePadding, stream->residuePaddings[residue]);
+			}
+			cursor += 1u;
+			return;
+		}
+
+		uint8_t padding = static_cast<uint8_t>((_alignment - (getAlignmentPosition() + 1u) % _alignment) % _alignment);
+		write(padding);
+		memset(allocate(padding), 0, padding);
+	}
+
+	size_t BinarySerializer::FDataBuffer::getAlignmentPosition() const
+	{
+		// In memory, the data of a length that does not fit in its padded size is moved once the length is known
+		return baseOffset + cursor - (stream ? stream->openExtraLengthSize : 0u);
+	}
+
+	void BinarySerializer::FDataBuffer::flush()
+	{
+		assert(stream && !stream->isCounting);
+
+		size_t flushSize = cursor;
+		for (const FLengthStream::Slot& slot : stream->openSlots)
+		{
+			if (!slot.isKnown)
+			{
+				flushSize = slot.position - baseOffset;
+				break;
+			}
+		}
+		if (flushSize == 0u)
+			return;
+
+		if (!stream->hasSinkFailed)
+		{
+			OutputSegment segment = { data, flushSize };
+			stream->hasSinkFailed = !stream->sink->write(&segment, 1);
+		}
+
+		memmove(data, data + flushSize, dataLength - flushSize);
+		cursor -= flushSize;
+		dataLength -= flushSize;
+		baseOffset += flushSize;
+	}
+
+	void BinarySerializer::FDataBuffer::seal()
+	{
+		assert(isOwningData);
+		assert(!stream);
+		assert(cursor == dataLength);
+
+		if (dataLength == 0u)
+			return;
+
+		sealedSegments.push_back({ data, dataLength, dataAllocatedSize });
+		baseOffset += dataLength;
+		cursor = 0u;
+		dataLength = 0u;
+		if (spareSegments.empty())
+		{
+			data = reinterpret_cast<uint8_t*>(malloc(dataAllocatedSize));
+		}
+		else
+		{
+			data = spareSegments.back().data;
+			dataAllocatedSize = spareSegments.back().allocatedSize;
+			spareSegments.pop_back();
+		}
+	}
+
+	void BinarySerializer::FDataBuffer::join()
+	{
+		assert(isOwningData);
+
+		if (sealedSegments.empty())
+			return;
+
+		size_t sealedSize = baseOffset;
+		size_t joinedAllocatedSize = std::max(sealedSize + dataLength, dataAllocatedSize);
+		uint8_t* joinedData = reinterpret_cast<uint8_t*>(malloc(joinedAllocatedSize));
+		size_t position = 0u;
+		for (const Segment& segment : sealedSegments)
+		{
+			memcpy(joinedData + position, segment.data, segment.size);
+			position += segment.size;
+		}
+		memcpy(joinedData + position, data, dataLength);
+
+		// The blocks are released, the joined one being as large as them
+		for (const Segment& segment : sealedSegments)
+		{
+			free(segment.data);
+		}
+		sealedSegments.clear();
+		free(data);
+		data = joinedData;
+		dataAllocatedSize = joinedAllocatedSize;
+		cursor += sealedSize;
+		dataLength += sealedSize;
+		baseOffset -= sealedSize;
+	}
+
+	void BinarySerializer::FDataBuffer::resetSegments()
+	{
+		spareSegments.insert(spareSegments.end(), sealedSegments.begin(), sealedSegments.end());
+		sealedSegments.clear();
 	}
 
 	bool BinarySerializer::FDataBuffer::read(void* _data, size_t _size)
@@ -411,13 +4662,18 @@ namespace mirror
 		return true;
 	}
 
+	bool BinarySerializer::FDataBuffer::readVarint(uint64_t& _outValue)
+	{
+		return ReadVarint(data, dataLength, cursor, _outValue);
+	}
+
 	void BinarySerializer::FDataBuffer::reserve(size_t _size)
 	{
 		assert(isOwningData);
 
-		if (dataLength + _size > dataAllocatedSize)
+		if (_size > dataAllocatedSize)
 		{
-			dataAllocatedSize = dataLength + _size * 2;
+			dataAllocatedSize = std::max(std::max(_size, dataAllocatedSize * 2u), MinDataAllocatedSize);
 			data = reinterpret_cast<uint8_t*>(realloc(data, dataAllocatedSize));
 		}
 	}
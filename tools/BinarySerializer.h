@@ -1,30 +1,118 @@
 #pragma once
 
+#include <atomic>
 #include <cassert>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "AsyncFile.h"
+#include "Compressor.h"
+#include "MappedFile.h"
+#include "OutputSink.h"
+
 namespace mirror
 {
+	class Allocator;
+	class ArenaAllocator;
+	class ThreadPool;
 	class Class;
+	class Enum;
 	class TypeDesc;
 	struct MetaDataSet; 
+	template <typename T> TypeDesc* GetTypeDesc();
 	class StdVectorTypeDescBase;
 	
 
+	// Writes the compact format:
+	//   header: magic "\x89MRB", format version, flags
+	//   records: names [u8 CompactRecord_Names][varint count][strings], appended to the name table of the file before the entries using them
+	//            entry [u8 CompactRecord_Entry][u32 id hash][varint length][payload]
+	// Lengths, counts and name table references are LEB128 varints, member ids are 32-bit hashes of their names,
+	// and enum values and the dynamic classes of owned pointers refer to the name table.
+	// Within an entry, an object owned through several pointers is written once, and pointers refer to it by its ordinal (version 2).
+	// Schemas [u8 CompactRecord_Schemas][varint count][class name hash, fingerprint, members], written before the first entry using the classes,
+	// let readers map the members of a class once per file (version 3).
+	// Deltas from a baseline leave out the members that did not change, and write vectors as the runs of their elements that changed (version 4).
+	// Schemas give the members that are not arithmetic values their encoded type and a hash of their sub types, so that retyped members are left out (version 5).
+	// Compressed data is a header with the compressed flag, the id of the compressor, then the blocks of the data above (see AppendCompressedBlock).
+	// Data in the legacy format (NUL terminated ids, size_t lengths, names written as strings) is still read.
 	class BinarySerializer
 	{
 	public:
+		static constexpr uint8_t CompactFormatVersion = 5u;
+
 		BinarySerializer();
 		~BinarySerializer();
 
+		// Serializer of the calling thread, used by SaveToFile and LoadFromFile. Its buffers come from a pool shared by all the serializers.
+		static BinarySerializer& GetThreadSerializer();
+		bool isBusy() const { return m_isWriting || m_isReading || m_isReadingIncremental; }
+
 		void beginWrite();
-		void endWrite();
+		// Streams the output to _sink by chunks of about _chunkSize bytes, so that the memory used does not grow with the size of the output.
+		// Each top level entry is measured before being written, so that the blocks larger than a chunk are written with their length up front.
+		void beginWrite(OutputSink* _sink, size_t _chunkSize = 1024u * 1024u);
+		// Returns false when the sink failed, or an entry could not be written (see ClassPlan::hasIdCollision)
+		bool endWrite();
+		// Writes in memory with _threadCount threads (1 by default). Top level entries are then written by endWrite(), so their objects must not change until then.
+		// Entries, and chunks of large vectors of classes, are serialized in per-thread buffers then stitched in order: the output is the same as with a single thread.
+		// Streamed writes use a single thread.
+		void setWriteThreadCount(size_t _threadCount);
+		size_t getWriteThreadCount() const { return m_writeThreadCount; }
+		// Data written in memory, empty after a streamed write. Segments are joined into a single block on the first call.
 		void getWriteData(const void*& _outData, size_t& _outDataLength) const;
-
+		// Data written in memory as the segments holding it, e.g. to write them with a FileDescriptorSink (writev) without joining them.
+		// Segments are valid until the next write, or until getWriteData joins them.
+		void getWriteSegments(std::vector<OutputSegment>& _outSegments) const;
+		// Writing in memory starts a new segment after the top level entry that fills the current one past _segmentSize bytes (not by default),
+		// so that the bytes written before are not copied again as the output grows. Entries larger than a segment grow theirs.
+		// The blocks of the segments are reused by the next writes.
+		void setWriteSegmentSize(size_t _segmentSize);
+		size_t getWriteSegmentSize() const { return m_writeSegmentSize; }
+		// Compresses the output by independent blocks of _blockSize bytes (e.g. with GetLZCompressor()), or not when null.
+		// Blocks are compressed as they are complete when streaming, and on the write threads when writing in memory.
+		// Reading detects compressed data and finds its compressor with FindCompressor.
+		void setCompressor(const Compressor* _compressor, size_t _blockSize = 256u * 1024u);
+		const Compressor* getCompressor() const { return m_compressor; }
+		size_t getCompressionBlockSize() const { return m_compressionBlockSize; }
+
+		// std::string_view and std::span members are read as views into _data, valid as long as _data is.
+		// When _data is compressed, it is decompressed at once and views point into the decompressed data, valid until the next read.
+		// Arrays that are not aligned in _data are copied to the allocator below, or else to memory of the serializer released by its next read.
 		void beginRead(const void* _data, size_t _dataLength);
-		void endRead();
+		// Returns false when the data could not be read, e.g. written by a newer version of the format or not decompressing, the objects being left as they were.
+		// Also false when an entry could not be read (see ClassPlan::hasIdCollision).
+		bool endRead();
+
+		// Reads compact data received by chunks of any size, e.g. from a pipe. The entries to read are declared with serialize() after beginIncrementalRead(),
+		// then each entry is decoded as far as the bytes fed allow, and only the bytes of the value being decoded are kept.
+		// Classes, vectors of classes or strings and raw arrays are decoded as their bytes arrive, other values once complete.
+		// Views (std::string_view, std::span) are copied as for unaligned arrays, the data fed not outliving the call.
+		void beginIncrementalRead();
+		// Returns false once the data is invalid
+		bool feed(const void* _data, size_t _dataLength);
+		// Returns false when the data was invalid or ended within a record
+		bool endIncrementalRead();
+
+		// Allocator used to instantiate the objects of owned pointers while reading (e.g. an ArenaAllocator for a load session).
+		// When null, objects are created with new.
+		void setAllocator(Allocator* _allocator) { m_allocator = _allocator; }
+		Allocator* getAllocator() const { return m_allocator; }
+
+		// Writes enums as numbers instead of references to their names, so that arrays of enums, and of classes holding enums, are copied as raw memory.
+		// Numbers are read back as is, whether or not they are values of the enum.
+		void setWriteEnumsAsNumbers(bool _writeEnumsAsNumbers) { m_writeEnumsAsNumbers = _writeEnumsAsNumbers; }
+		bool getWriteEnumsAsNumbers() const { return m_writeEnumsAsNumbers; }
+
+		// Serializes the members of classes one by one from Class::getMembers, as before the class plans, instead of with the plan cached for the class.
+		// The output is the same. Meant to measure the plans: without them, the schemas of the data read are not used either.
+		void setUseClassPlans(bool _useClassPlans) { m_useClassPlans = _useClassPlans; }
+		bool getUseClassPlans() const { return m_useClassPlans; }
 
 		template <typename T> void serialize(const char* _id, T& _object)
 		{
@@ -37,8 +125,96 @@ namespace mirror
 			_serializeEntry( dataBuffer, _id, &_object, GetTypeDesc(_object));
 		}
 
+		// Writes _object as a delta from _baseline: only the members that differ, down to the members of classes and the elements of vectors that changed.
+		// Reading the output into objects holding the baseline gives _object back. An entry that did not change is not written.
+		// Values holding pointers are written whole when they are part of the delta, and streamed writes write whole entries.
+		template <typename T> void serialize(const char* _id, T& _object, const T& _baseline)
+		{
+			assert(m_isWriting);
+			_serializeDeltaEntry(_id, &_object, &_baseline, GetTypeDesc(_object));
+		}
+		// Same with the entry _id of data written before, e.g. the previous save, which is read first. The whole entry is written when it has no such entry.
+		template <typename T> void serialize(const char* _id, T& _object, const void* _baselineData, size_t _baselineDataLength)
+		{
+			assert(m_isWriting);
+			T baseline;
+			BinarySerializer baselineReader;
+			baselineReader.beginRead(_baselineData, _baselineDataLength);
+			bool hasBaseline = baselineReader._readBaselineEntry(_id, &baseline, GetTypeDesc(baseline));
+			baselineReader.endRead();
+
+			if (hasBaseline)
+				_serializeDeltaEntry(_id, &_object, &baseline, GetTypeDesc(_object));
+			else
+				_serializeEntry(m_writeDataBuffer, _id, &_object, GetTypeDesc(_object));
+		}
+
+		// Exact size of the bytes serialize(_id, _object) adds to the output being written, or of an output holding only this entry outside of a write.
+		// Counted by running the writer without storing anything. Compressed outputs are smaller.
+		template <typename T> size_t getSerializedSize(const char* _id, T& _object)
+		{
+			return _getSerializedSize(_id, &_object, GetTypeDesc(_object));
+		}
+		// Allocates room for _size more bytes in the buffer written to in memory, e.g. from getSerializedSize, so that it does not grow while writing
+		void reserveWriteData(size_t _size);
+
+		// Reads the value at _path of compact data being read, without decoding the rest of it, e.g. get<Level>("level.entities[1200].health", health).
+		// The path starts with the id of an entry of type Root, then names members of classes (also through owned pointers and optionals) and indices
+		// of vectors and arrays. The payloads of the other members and elements are skipped through their lengths.
+		// Arithmetic values of another type are converted. Returns false when the path is not in the data or not in the types.
+		template <typename Root, typename T> bool get(const char* _path, T& _outValue)
+		{
+			assert(m_isReading);
+			return _getPath(_path, GetTypeDesc<Root>(), &_outValue, GetTypeDesc(_outValue));
+		}
+		// Indexes the members of the classes and the elements of the vectors that get() goes through, until the next read.
+		// Further paths through them then take a time linear in their number of steps, whatever the number of members and elements skipped.
+		void setIndexPaths(bool _indexPaths) { m_indexPaths = _indexPaths; }
+		bool getIndexPaths() const { return m_indexPaths; }
+
+		// Whether values of _typeDesc may hold std::string_view or std::span members, which are read as views into the data
+		bool holdsViews(const TypeDesc* _typeDesc);
+		// Only reads views into the data given to beginRead: views that would point into decompressed data, or into copies of unaligned or converted
+		// arrays, are left empty and fail endRead. For data outliving the serializer, whose next read frees these bytes.
+		void setKeepViewsInData(bool _keepViewsInData) { m_keepViewsInData = _keepViewsInData; }
+		bool getKeepViewsInData() const { return m_keepViewsInData; }
+		// Whether the data being read had the last entry serialize() read
+		bool hasReadEntry() const { return m_hasReadEntry; }
+
 	private:
 
+		// Lengths of a streamed or measured output, see FDataBuffer::reserveLength
+		struct FLengthStream
+		{
+			struct Slot
+			{
+				size_t position;
+				size_t ordinal;
+				size_t knownLength;
+				bool isKnown;
+			};
+
+			OutputSink* sink = nullptr;
+			size_t chunkSize = 0u;
+			bool isCounting = false; // Only moves the cursor, to measure the lengths
+			bool hasSinkFailed = false;
+
+			std::vector<Slot> openSlots;
+			size_t ordinal = 0u;
+			// Lengths of at least chunkSize bytes, by ordinal of their reservation, measured before writing
+			std::vector<std::pair<size_t, size_t>> knownLengths;
+			size_t nextKnownLength = 0u;
+			// Bytes of the known lengths being written that do not fit in the padded size, see FDataBuffer::getAlignmentPosition
+			size_t openExtraLengthSize = 0u;
+			std::vector<uint8_t> scratch;
+
+			// Counts the padding of raw values for each residue of the start position modulo residueCount, when not 0
+			size_t residueCount = 0u;
+			std::vector<size_t> residuePaddings;
+			size_t maxResiduePadding = 0u;
+			bool hasResidueFailed = false; // Alignment above residueCount, or length whose size depends on the residue
+		};
+
 		struct FDataBuffer
 		{
 			FDataBuffer();
@@ -52,6 +228,25 @@ namespace mirror
 
 			bool isOwningData = true;
 
+			// Position of data in the whole output, when the bytes before it were flushed to a sink
+			size_t baseOffset = 0u;
+			FLengthStream* stream = nullptr;
+			// Names of the table the data may refer to, when written ahead of the names added for later entries
+			size_t visibleNameCount = SIZE_MAX;
+			struct Segment
+			{
+				uint8_t* data;
+				size_t size;
+				size_t allocatedSize;
+			};
+			// Owned blocks of the bytes before data in memory, which end at baseOffset, and blocks of previous writes to reuse
+			std::vector<Segment> sealedSegments;
+			std::vector<Segment> spareSegments;
+
+			bool isCounting() const { return stream && stream->isCounting; }
+			// The rest of a streamed output is thrown away once its sink failed, on an I/O error or a cancelled save
+			bool hasSinkFailed() const { return stream && stream->hasSinkFailed; }
+
 			template <typename T>
 			void write(const T& _object)
 			{
@@ -70,6 +265,32 @@ namespace mirror
 			}
 
 			void write(const void* _data, size_t _size);
+			// Moves the cursor past _size bytes to be written by the caller, and returns them
+			uint8_t* allocate(size_t _size);
+
+			void writeVarint(uint64_t _value);
+
+			// Length prefixes are reserved before writing the data they prefix, then patched with the size of the data written after them.
+			// This way each byte is written once, directly at its final place, whatever the nesting depth.
+			// The reserved varint is padded to 4 bytes, the data is only moved when its length does not fit in them.
+			// When streaming, the bytes before the first length to patch are flushed, and lengths measured beforehand are written directly.
+			// Positions are in the whole output.
+			size_t reserveLength();
+			// Returns by how many bytes the data was moved
+			size_t patchLength(size_t _lengthPosition);
+
+			// Position used to align raw values, the same whether the lengths of the enclosing blocks are patched or written up front
+			size_t getAlignmentPosition() const;
+			// Writes the size of the padding, then the padding aligning the bytes after it to _alignment
+			void writePadding(size_t _alignment);
+			// Writes the bytes that are final to the sink
+			void flush();
+			// Keeps the bytes written in memory as a segment, and goes on in a new block. No length must be left to patch in them.
+			void seal();
+			// Moves the sealed segments and the data into a single block
+			void join();
+			// Keeps the blocks of the sealed segments to reuse them
+			void resetSegments();
 
 			template <typename T>
 			bool read(T& _object)
@@ -96,10 +317,241 @@ namespace mirror
 
 			bool read(void* _data, size_t _size);
 
+			bool readVarint(uint64_t& _outValue);
+
+			// Grows the allocated size to at least _size bytes, by doubling it
 			void reserve(size_t _size);
 		};
 
+		struct ReadSchema;
+
+		// Everything needed to serialize the members of a class, computed on the first use of the class
+		struct ClassPlan
+		{
+			struct Member
+			{
+				const char* id = nullptr;
+				size_t idSize = 0u; // Including the terminating zero
+				uint32_t idHash = 0u;
+				size_t offset = 0u;
+				const TypeDesc* type = nullptr;
+				const MetaDataSet* metaDataSet = nullptr;
+				size_t fixedSize = 0u; // Size of the payload when it does not depend on the instance, 0 otherwise
+			};
+
+			// Consecutive members with fixed size payloads, written at once from a template holding their ids and lengths
+			struct Run
+			{
+				size_t firstMember = 0u;
+				size_t memberCount = 0u;
+				std::vector<uint8_t> entriesTemplate;
+				std::vector<size_t> payloadOffsets;
+			};
+
+			std::vector<Member> members;
+			std::vector<Run> runs; // Runs of variable size members hold a single member and no template
+			// Two members have the same id hash, or the class the same name hash as another type, which the readers could not tell apart:
+			// entries holding the class are neither written nor read
+			bool hasIdCollision = false;
+
+			// Schema written in the files: member id hashes, kinds and fixed sizes in the order they are written, and their hash
+			uint32_t classNameHash = 0u;
+			uint32_t fingerprint = 0u;
+			std::vector<uint8_t> schema;
+
+			// Schema of the class in the file being read, looked up once per read
+			mutable const ReadSchema* readSchema = nullptr;
+			mutable size_t readSchemaGeneration = 0u;
+		};
+
+		const ClassPlan* _getClassPlan(const Class* _class);
+
+		// Schema of a class in the file being read, with the reader member of each of its members, mapped when first used
+		struct ReadSchema
+		{
+			struct Member
+			{
+				uint32_t idHash = 0u;
+				uint8_t kind = 0u;
+				size_t fixedSize = 0u;
+				uint32_t typeHash = 0u; // Of the values that are not arithmetic (version 5)
+				const ClassPlan::Member* target = nullptr; // Null when the reader has no member with this id
+				bool isConverted = false; // Arithmetic value of another kind
+				uint8_t targetKind = 0u;
+				uint8_t header[16]; // Id hash and length, when the payload is copied as is
+				size_t headerSize = 0u;
+			};
+
+			uint32_t fingerprint = 0u;
+			std::vector<Member> members;
+			bool isMapped = false;
+		};
+
+		// Classes whose schemas values of _typeDesc may need
+		const std::vector<const Class*>& _getReachableClasses(const TypeDesc* _typeDesc);
+		// Whether a class values of _typeDesc may hold has members or a name with the same hash as others, see ClassPlan::hasIdCollision
+		bool _hasIdCollision(const TypeDesc* _typeDesc);
+		void _writeSchemas(const std::vector<const Class*>& _classes);
+		bool _readSchemas(FDataBuffer* _dataBuffer);
+		const ReadSchema* _getReadSchema(const ClassPlan* _plan);
+		// Reads the member entries in the order of the schema, with a lookup by id hash for the entries out of order
+		void _readSchemaMembers(FDataBuffer* _dataBuffer, const ReadSchema* _schema, uint8_t* _instance);
+
+		// Arithmetic and enum values of a type, flattened through nested classes and fixed size arrays.
+		// Arrays of types made only of these values are copied as raw memory, after a description of the values
+		// that lets a reader whose layout differs pick the values it knows.
+		struct RawLayout
+		{
+			struct Field
+			{
+				uint32_t pathHash = 0u; // Hash of the member path, e.g. "position.x" or "weights[2]"
+				size_t offset = 0u;
+				uint8_t kind = 0u;
+				size_t count = 0u;
+			};
+
+			std::vector<Field> fields;
+			size_t elementSize = 0u;
+			size_t elementAlignment = 1u;
+			bool isRawCopyable = false; // No padding, no virtual table, no other kind of value
+			bool isValue = false; // Arithmetic or enum type
+			bool hasEnums = false;
+			std::vector<uint8_t> description;
+		};
+
+		struct RawBlock
+		{
+			uint8_t encoding = 0u;
+			const uint8_t* description = nullptr;
+			size_t descriptionSize = 0u;
+			const uint8_t* data = nullptr;
+			size_t elementSize = 0u;
+		};
+
+		static bool _flattenRawFields(const TypeDesc* _typeDesc, std::string& _path, size_t _offset, RawLayout& _layout);
+		const RawLayout* _getRawLayout(const TypeDesc* _typeDesc);
+		bool _canWriteRaw(const RawLayout* _layout) const;
+		// Writes the encoding, the description, then the values aligned in the output
+		void _writeRawBlock(FDataBuffer* _dataBuffer, const RawLayout* _layout, const void* _data, size_t _count);
+		bool _readRawBlock(FDataBuffer* _dataBuffer, uint8_t _encoding, size_t _count, RawBlock& _outBlock);
+		// Copies the values of _block to _count elements starting at _destination, matching them by path when the layouts differ
+		void _copyRawBlock(const RawBlock& _block, const RawLayout* _layout, size_t _count, uint8_t* _destination);
+
+		// Entries of a block sorted by id hash, built the first time an entry is not found in the expected order
+		struct EntryIndex
+		{
+			struct Entry
+			{
+				uint32_t idHash;
+				size_t idPosition;
+				size_t payloadPosition;
+				size_t payloadSize;
+			};
+
+			bool isBuilt = false;
+			std::vector<Entry> entries;
+
+			void add(uint32_t _idHash, size_t _idPosition, size_t _payloadPosition, size_t _payloadSize);
+			void sort();
+			void build(const FDataBuffer* _dataBuffer, bool _isCompact);
+			const Entry* find(const FDataBuffer* _dataBuffer, const char* _id, uint32_t _idHash, bool _isCompact) const;
+		};
+
+		// Takes the entry at the cursor of the block if it is _id, otherwise looks _id up in the index of the block, so that reading a block is linear in its size
+		bool _findEntry(FDataBuffer* _dataBuffer, EntryIndex& _index, const char* _id, size_t _idSize, uint32_t _idHash, uint8_t*& _outPayload, size_t& _outPayloadSize);
+		// Same for the top level records of the compact format, loading the names records met on the way
+		bool _findRootEntry(const char* _id, uint32_t _idHash, uint8_t*& _outPayload, size_t& _outPayloadSize);
+		void _readMembers(FDataBuffer* _dataBuffer, const ClassPlan* _plan, uint8_t* _instance);
+		// Writes or reads the members of _object without class plan (setUseClassPlans(false))
+		void _serializeMembers(FDataBuffer* _dataBuffer, const Class* _class, void* _object);
+
+		// Steps of get(): each one narrows _value to the payload of a member or an element, and sets its type.
+		// Elements of raw blocks are not serialized values, they are returned in _outRawBlock and _outRawElement instead.
+		bool _getPath(const char* _path, const TypeDesc* _rootTypeDesc, void* _object, const TypeDesc* _typeDesc);
+		bool _findPathMember(FDataBuffer& _value, const TypeDesc*& _typeDesc, const MetaDataSet*& _metaDataSet, const std::string& _name);
+		bool _findPathElement(FDataBuffer& _value, const TypeDesc*& _typeDesc, const MetaDataSet*& _metaDataSet, size_t _index, RawBlock& _outRawBlock, const uint8_t*& _outRawElement);
+		// Moves the cursor past a value of _typeDesc
+		bool _skipValue(FDataBuffer* _dataBuffer, const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet);
+
+		// Entry to read incrementally, declared by serialize()
+		struct IncrementalTarget
+		{
+			uint32_t idHash;
+			void* object;
+			const TypeDesc* typeDesc;
+			const MetaDataSet* metaDataSet;
+		};
+
+		// Bytes of the input being decoded incrementally, nested from the top level records
+		struct IncrementalFrame
+		{
+			enum Kind : uint8_t
+			{
+				Kind_Records, // Until the end of the input
+				Kind_Skip, // Entry that is not read
+				Kind_Value, // Decoded at once when complete, otherwise continued as one of the kinds below
+				Kind_Members, // Member entries of a class
+				Kind_Elements, // Vector of elements prefixed by their length (classes, strings)
+				Kind_RawValues, // Raw block of a vector, copied by whole elements
+				Kind_ConvertedValue, // Arithmetic member whose kind changed, see ReadSchema
+			};
+
+			Kind kind = Kind_Records;
+			size_t endPosition = SIZE_MAX;
+			uint8_t* object = nullptr;
+			const TypeDesc* typeDesc = nullptr;
+			const MetaDataSet* metaDataSet = nullptr;
+			const ClassPlan* plan = nullptr;
+			size_t index = 0u;
+			size_t count = 0u;
+			RawBlock rawBlock; // Description pointing to rawDescription
+			std::vector<uint8_t> rawDescription;
+			uint8_t sourceKind = 0u;
+			uint8_t targetKind = 0u;
+		};
+
+		// Decodes as much of _data as possible, returns the size decoded and sets m_incrementalNeededSize
+		size_t _decodeIncremental(const uint8_t* _data, size_t _dataLength);
+		// Feeds decompressed data
+		bool _feedDecoded(const uint8_t* _data, size_t _dataLength);
+		// Decompresses the blocks of compressed feeds as they are complete
+		void _feedCompressed(const uint8_t* _data, size_t _dataLength);
+
+		void _writeCompressedHeader(uint8_t* _outHeader) const;
+		// Compresses the data written in memory into m_compressedWriteData
+		void _compressWriteData();
+		// Decompresses _data into m_decompressedData
+		bool _decompress(const uint8_t* _data, size_t _dataLength);
+
+		// Names that values of _typeDesc may refer to: enum values, and the classes that may be found behind owned pointers
+		const std::vector<const char*>& _getReachableNames(const TypeDesc* _typeDesc);
+		void _writeNames(const std::vector<const char*>& _names);
+		// Adds the names missing from the table, returns the index of the first one
+		size_t _addNames(const std::vector<const char*>& _names);
+		void _writeNamesRecord(size_t _firstName, size_t _nameCount);
+		bool _readNames(FDataBuffer* _dataBuffer);
+		void _writeNameReference(FDataBuffer* _dataBuffer, const char* _name);
+		const TypeDesc* _readClassReference(FDataBuffer* _dataBuffer);
+
+		void _writeString(FDataBuffer* _dataBuffer, const char* _string, size_t _length);
+		bool _readString(FDataBuffer* _dataBuffer, std::string& _outString);
+		// Points into the data being read, without copy
+		bool _readStringView(FDataBuffer* _dataBuffer, const char*& _outString, size_t& _outLength);
+		void _writeEnum(FDataBuffer* _dataBuffer, const void* _object, const Enum* _enum);
+		void _readEnum(FDataBuffer* _dataBuffer, void* _object, const Enum* _enum);
+		// Lengths and element counts
+		bool _readLength(FDataBuffer* _dataBuffer, size_t& _outLength);
+		// Allocator of the copies of views that cannot point into the data read
+		Allocator* _getViewAllocator();
+
 		void _serializeEntry(FDataBuffer* _dataBuffer, const char* _id, void* _object, const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet = nullptr);
+		void _serializeDeltaEntry(const char* _id, void* _object, const void* _baseline, const TypeDesc* _typeDesc);
+		// Writes what differs from _baseline, and returns false when nothing does, the caller then dropping what was written
+		bool _writeDelta(FDataBuffer* _dataBuffer, void* _object, const void* _baseline, const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet);
+		bool _readBaselineEntry(const char* _id, void* _object, const TypeDesc* _typeDesc);
+		size_t _getSerializedSize(const char* _id, void* _object, const TypeDesc* _typeDesc);
+		// Runs the writing of an entry record without storing it, to know the lengths of the large blocks before streaming them
+		void _measureEntryRecord(FDataBuffer* _dataBuffer, uint32_t _idHash, void* _object, const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet);
 		void _serialize(FDataBuffer* _dataBuffer, void* _object, const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet = nullptr);
 		template <typename T>
 		void _serialize(FDataBuffer* _dataBuffer, void* _object)
@@ -115,67 +567,360 @@ namespace mirror
 			}
 		}
 
-		FDataBuffer* _getDataBufferFromPool();
-		void _releaseDataBufferToPool(FDataBuffer* _dataBuffer);
+		// Objects owned through a pointer are prefixed by the name of their dynamic class.
+		// When the entry holds raw pointers, they also get an ordinal, and the pointers reaching an object already written refer to its ordinal.
+		void _writeOwnedObject(FDataBuffer* _dataBuffer, void* _object, const TypeDesc* _subType);
+		// References are set once the entry is read when _pointer is given, otherwise read as null.
+		// Without _allocator, the object is created with new and can be deleted by its owner.
+		void* _readOwnedObject(FDataBuffer* _dataBuffer, const TypeDesc* _subType, Allocator* _allocator, void** _pointer);
+		// Pointers that do not own their object, written as references to objects of owned pointers of the same entry, or null
+		void _writePointer(FDataBuffer* _dataBuffer, const void* _object);
+		void _readPointer(FDataBuffer* _dataBuffer, void** _pointer);
+		// Kinds of raw pointers reachable from _typeDesc, see PointerFlag
+		uint8_t _getPointerFlags(const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet);
+		// Starts the object table of an entry. When pointers may refer to objects written after them, the ordinals are collected first by a counting pass.
+		void _beginWriteObjects(void* _object, const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet);
+		void _endWriteObjects();
+		// Sets the pointers read as references, then clears the object table
+		void _endReadObjects();
+
+		// Top level entry deferred to endWrite() when writing with several threads
+		struct ParallelEntry
+		{
+			uint32_t idHash;
+			void* object;
+			const TypeDesc* typeDesc;
+			const MetaDataSet* metaDataSet;
+			size_t firstName;
+			size_t nameCount;
+		};
 
-		std::vector<FDataBuffer*> m_dataBufferPool;
+		// Value, or chunk of the elements of a vector, serialized by a thread
+		struct ParallelPart
+		{
+			void* object = nullptr;
+			const TypeDesc* typeDesc = nullptr;
+			const MetaDataSet* metaDataSet = nullptr;
+			size_t firstElement = 0u;
+			size_t elementCount = 0u; // 0 for the whole value
+			size_t visibleNameCount = 0u;
+			std::vector<size_t> residueSizes; // Size for each residue of the alignment position
+			size_t alignmentPosition = 0u;
+			size_t position = 0u; // In the output
+			size_t size = 0u;
+		};
+
+		struct ParallelWorker
+		{
+			FDataBuffer dataBuffer;
+			FLengthStream measureStream;
+		};
+
+		// Data moved by a length that did not fit in its padded size, after the parts reserved before it
+		struct ParallelShift
+		{
+			size_t lengthPosition;
+			size_t shift;
+			size_t partCount;
+		};
+
+		void _writeParallelEntries();
+		// Calls _getClassPlan and _getRawLayout for the types reachable from _typeDesc, so that the threads only read the caches
+		void _prepareTypes(const TypeDesc* _typeDesc, std::unordered_set<const TypeDesc*>& _visitedTypes);
+		bool _isParallelSplit(void* _object, const TypeDesc* _typeDesc);
+		// Walks the value down to the vectors split in chunks. Without a buffer, lists the parts, otherwise writes around them and reserves their size.
+		void _splitParallelValue(FDataBuffer* _dataBuffer, void* _object, const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet, size_t _visibleNameCount);
+		void _addParallelPart(FDataBuffer* _dataBuffer, void* _object, const TypeDesc* _typeDesc, const MetaDataSet* _metaDataSet, size_t _firstElement, size_t _elementCount, size_t _visibleNameCount);
+		void _writeParallelPart(FDataBuffer* _dataBuffer, const ParallelPart& _part);
+
+		// Lock-free: each slot holds a buffer or null, and is taken or filled by an atomic exchange
+		struct alignas(64) DataBufferSlot
+		{
+			std::atomic<FDataBuffer*> dataBuffer{ nullptr };
+		};
+		static constexpr size_t DataBufferPoolSize = 32u;
+		static DataBufferSlot s_dataBufferPool[DataBufferPoolSize];
+
+		static FDataBuffer* _getDataBufferFromPool();
+		static void _releaseDataBufferToPool(FDataBuffer* _dataBuffer);
+
+		std::unordered_map<const Class*, ClassPlan*> m_classPlans;
+		std::unordered_map<const TypeDesc*, std::vector<const char*>> m_reachableNames;
+		std::unordered_map<const TypeDesc*, std::vector<const Class*>> m_reachableClasses;
+		std::unordered_map<const TypeDesc*, RawLayout*> m_rawLayouts;
 
 		FDataBuffer* m_writeDataBuffer = nullptr;
+		FLengthStream m_writeStream;
+		FDataBuffer m_measureDataBuffer;
+		FLengthStream m_measureStream;
+		FDataBuffer m_deltaDataBuffer; // Baseline values written to compare them with the values written
+		// Name table of the file being written, by name pointer, and by index
+		std::unordered_map<const char*, uint32_t> m_writeNameIndices;
+		std::vector<const char*> m_writeNames;
+		std::unordered_set<const Class*> m_writeSchemaClasses;
+
+		const Compressor* m_compressor = nullptr;
+		size_t m_compressionBlockSize = 256u * 1024u;
+		CompressingSink* m_compressingSink = nullptr;
+		std::vector<uint8_t> m_compressedWriteData;
+		std::vector<std::vector<uint8_t>> m_compressedBlocks; // Compressed by each thread
+		bool m_isWriteDataCompressed = false;
+		bool m_hasWriteFailed = false; // An entry could not be written
+		std::vector<uint8_t> m_decompressedData;
+
+		size_t m_writeThreadCount = 1u;
+		size_t m_writeSegmentSize = SIZE_MAX;
+		ThreadPool* m_threadPool = nullptr;
+		std::vector<ParallelWorker*> m_parallelWorkers;
+		std::vector<ParallelEntry> m_parallelEntries;
+		std::vector<ParallelPart> m_parallelParts;
+		size_t m_parallelPartIndex = 0u;
+		std::vector<ParallelShift> m_parallelShifts;
+		// Caches filled while the threads run, merged after
+		bool m_isWritingInParallel = false;
+		std::mutex m_parallelMutex;
+		std::unordered_map<const Class*, ClassPlan*> m_parallelClassPlans;
+		std::unordered_map<const TypeDesc*, RawLayout*> m_parallelRawLayouts;
+
+		// Objects of owned pointers of the entry being written, by address, with their ordinal
+		std::unordered_map<const void*, size_t> m_writeObjectOrdinals;
+		size_t m_writeObjectCount = 0u;
+		bool m_isWritingObjects = false;
+		std::unordered_map<const TypeDesc*, uint8_t> m_pointerFlags;
+
+		struct ReadName
+		{
+			std::string name;
+			const TypeDesc* type = nullptr; // Resolved on first use
+			const Enum* enumType = nullptr; // Enum of the last value read with this name
+			int64_t enumValue = 0;
+		};
+
 		FDataBuffer m_readDataBuffer;
+		EntryIndex m_readEntryIndex;
+		std::vector<ReadName> m_readNames;
+		size_t m_readRecordsPosition = 0u;
+		bool m_isReadingCompact = false;
+		bool m_isReadingTransientData = false; // Views are copied
+		bool m_isReadingDecompressedData = false;
+		bool m_keepViewsInData = false;
+		bool m_hasReadEntry = false;
+		uint8_t m_readVersion = 0u;
+		bool m_hasReadFailed = false;
+		std::unordered_map<uint32_t, ReadSchema> m_readSchemas; // By class name hash
+		size_t m_readSchemaGeneration = 0u;
+		// Objects of owned pointers of the entry being read, by ordinal, and the pointers referring to them
+		std::unordered_map<size_t, void*> m_readObjects;
+		std::vector<std::pair<void**, size_t>> m_readObjectReferences;
+		// Indices of get(), by position of the data of the classes, and of the first element of the vectors, in m_readDataBuffer
+		std::unordered_map<size_t, EntryIndex> m_pathMemberIndices;
+		std::unordered_map<size_t, std::vector<size_t>> m_pathElementPositions;
+		bool m_indexPaths = false;
+
+		std::vector<IncrementalTarget> m_incrementalTargets;
+		std::vector<IncrementalFrame> m_incrementalFrames;
+		std::vector<uint8_t> m_incrementalBuffer; // Bytes fed that could not be decoded yet
+		size_t m_incrementalPosition = 0u; // Of the first byte not decoded, in the whole input
+		size_t m_incrementalNeededSize = 0u; // From m_incrementalPosition, to decode further
+		bool m_isReadingIncremental = false;
+		enum IncrementalCompression
+		{
+			IncrementalCompression_Unknown, // Until the header is fed
+			IncrementalCompression_None,
+			IncrementalCompression_Blocks,
+		};
+		IncrementalCompression m_incrementalCompression = IncrementalCompression_Unknown;
+		const Compressor* m_incrementalCompressor = nullptr;
+		std::vector<uint8_t> m_incrementalCompressedBuffer; // Header, or blocks fed that are not complete yet
+		std::vector<uint8_t> m_incrementalBlock;
+		bool m_hasIncrementalFailed = false;
+
+		Allocator* m_allocator = nullptr;
+		ArenaAllocator* m_viewAllocator = nullptr;
 
 		bool m_isWriting = false;
 		bool m_isReading = false;
+		bool m_writeEnumsAsNumbers = false;
+		bool m_useClassPlans = true;
 	};
 
 
-	static BinarySerializer s_staticSerializer;
-
-	template <typename T>
-	static bool SaveToFile(T& _data, const char* _fileName)
+	// Calls _function with the serializer of the thread, or with a new one when it is busy (e.g. when saving from within a serialization)
+	template <typename Function>
+	static auto CallWithThreadSerializer(Function _function)
 	{
-		s_staticSerializer.beginWrite();
-		s_staticSerializer.serialize("", _data);
-		s_staticSerializer.endWrite();
+		BinarySerializer& threadSerializer = BinarySerializer::GetThreadSerializer();
+		if (!threadSerializer.isBusy())
+			return _function(threadSerializer);
 
-		const void* data = nullptr;
-		size_t dataSize = 0u;
-		s_staticSerializer.getWriteData(data, dataSize);
+		BinarySerializer serializer;
+		return _function(serializer);
+	}
 
-		FILE* fp = fopen(_fileName, "w");
+	// Thread-safe: each thread uses its own serializer. Encodes in memory, then writes the segments to the file at once.
+	// With _chunkSize, streams by chunks of about _chunkSize bytes instead, so that the memory used does not grow with the size of the data,
+	// at the cost of encoding each entry twice to measure it first.
+	template <typename T>
+	static bool SaveToFile(T& _data, const char* _fileName, const Compressor* _compressor = nullptr, size_t _chunkSize = 0u)
+	{
+		FILE* fp = fopen(_fileName, "wb");
 		if (!fp)
 			return false;
 
-		fwrite(data, dataSize, 1, fp);
-		fclose(fp);
+		bool isWritten = CallWithThreadSerializer([&](BinarySerializer& _serializer)
+		{
+			// The compressor of the thread serializer is given back, other saves of the thread may not use one
+			const Compressor* compressor = _serializer.getCompressor();
+			size_t compressionBlockSize = _serializer.getCompressionBlockSize();
+			_serializer.setCompressor(_compressor);
+
+			bool isEncoded = false;
+			if (_chunkSize > 0u)
+			{
+				FileSink sink(fp);
+				_serializer.beginWrite(&sink, _chunkSize);
+				_serializer.serialize("", _data);
+				isEncoded = _serializer.endWrite();
+			}
+			else
+			{
+				_serializer.beginWrite();
+				_serializer.serialize("", _data);
+				isEncoded = _serializer.endWrite();
+				if (isEncoded)
+				{
+					std::vector<OutputSegment> segments;
+					_serializer.getWriteSegments(segments);
+#ifdef _WIN32
+					FileDescriptorSink sink(_fileno(fp));
+#else
+					FileDescriptorSink sink(fileno(fp));
+#endif
+					isEncoded = sink.write(segments.data(), segments.size());
+				}
+			}
+
+			_serializer.setCompressor(compressor, compressionBlockSize);
+			return isEncoded;
+		});
 
-		return true;
+		return fclose(fp) == 0 && isWritten;
 	}
 
+	// Size of the file SaveToFile writes without compressor
+	template <typename T>
+	static size_t SerializedSize(T& _data)
+	{
+		return CallWithThreadSerializer([&](BinarySerializer& _serializer)
+		{
+			return _serializer.getSerializedSize("", _data);
+		});
+	}
+
+	// Decodes straight from a mapping of the file. Views read into _data stay valid until _file is closed: the views of a compressed file,
+	// and spans whose values would have to be copied, are left empty and fail the load. Returns false as well when the file has no data.
+	template <typename T>
+	static bool LoadFromMappedFile(T& _data, const MappedFile& _file)
+	{
+		if (!_file.isOpen())
+			return false;
+
+		return CallWithThreadSerializer([&](BinarySerializer& _serializer)
+		{
+			bool keepViewsInData = _serializer.getKeepViewsInData();
+			_serializer.setKeepViewsInData(true);
+			_serializer.beginRead(_file.getData(), _file.getSize());
+			_serializer.serialize("", _data);
+			bool isRead = _serializer.hasReadEntry();
+			isRead = _serializer.endRead() && isRead;
+			_serializer.setKeepViewsInData(keepViewsInData);
+			return isRead;
+		});
+	}
+
+	// Returns false without reading for types holding views (std::string_view, std::span), which would point into the file closed on return:
+	// load them with LoadFromMappedFile instead.
 	template <typename T>
 	static bool LoadFromFile(T& _data, const char* _fileName)
 	{
-		size_t dataSize = 0u;
-		void* data = nullptr;
+		bool holdsViews = CallWithThreadSerializer([&](BinarySerializer& _serializer)
+		{
+			return _serializer.holdsViews(GetTypeDesc(_data));
+		});
+		if (holdsViews)
+			return false;
 
-		FILE* fp = fopen(_fileName, "r");
-		if (!fp)
+		MappedFile file;
+		if (!file.open(_fileName))
 			return false;
 
-		fseek(fp, 0, SEEK_END);
-		dataSize = ftell(fp);
-		fseek(fp, 0, SEEK_SET);
+		return LoadFromMappedFile(_data, file);
+	}
 
-		data = malloc(dataSize);
+	// Saves from a thread of its own, which encodes the data while another one writes the chunks already encoded. _data must not change until the operation is done.
+	// A save that fails or is cancelled removes the file.
+	template <typename T>
+	static std::unique_ptr<AsyncOperation> SaveToFileAsync(T& _data, const char* _fileName, const Compressor* _compressor = nullptr, size_t _chunkSize = 1024u * 1024u)
+	{
+		std::string fileName = _fileName;
+		return std::unique_ptr<AsyncOperation>(new AsyncOperation([&_data, fileName, _compressor, _chunkSize](const AsyncOperation& _operation)
+		{
+			FILE* fp = fopen(fileName.c_str(), "wb");
+			if (!fp)
+				return false;
 
-		fread(data, dataSize, 1, fp);
-		fclose(fp);
+			bool isWritten = false;
+			{
+				FileSink fileSink(fp);
+				AsyncWriteSink sink(&fileSink, _chunkSize, &_operation);
+				BinarySerializer serializer;
+				serializer.setCompressor(_compressor);
+				serializer.beginWrite(&sink, _chunkSize);
+				serializer.serialize("", _data);
+				bool isEncoded = serializer.endWrite();
+				isWritten = sink.finish() && isEncoded;
+			}
 
-		s_staticSerializer.beginRead(data, dataSize);
-		s_staticSerializer.serialize("", _data);
-		s_staticSerializer.endRead();
+			bool isSaved = fclose(fp) == 0 && isWritten && !_operation.isCancelled();
+			if (!isSaved)
+				remove(fileName.c_str());
+			return isSaved;
+		}));
+	}
 
-		free(data);
+	// Loads from a thread of its own, which decodes each chunk of the file while another one reads the next. _data must not be used until the operation is done.
+	// Fails like LoadFromFile for types holding views (std::string_view, std::span), which must be loaded with LoadFromMappedFile.
+	template <typename T>
+	static std::unique_ptr<AsyncOperation> LoadFromFileAsync(T& _data, const char* _fileName, size_t _chunkSize = 1024u * 1024u)
+	{
+		std::string fileName = _fileName;
+		return std::unique_ptr<AsyncOperation>(new AsyncOperation([&_data, fileName, _chunkSize](const AsyncOperation& _operation)
+		{
+			// The copies of the views would be freed with the serializer
+			BinarySerializer serializer;
+			if (serializer.holdsViews(GetTypeDesc(_data)))
+				return false;
+
+			FILE* fp = fopen(fileName.c_str(), "rb");
+			if (!fp)
+				return false;
+
+			serializer.beginIncrementalRead();
+			serializer.serialize("", _data);
+			bool isFed = true;
+			{
+				AsyncFileReader reader(fp, _chunkSize);
+				const uint8_t* data = nullptr;
+				size_t size = 0u;
+				do
+				{
+					isFed = !_operation.isCancelled() && reader.read(data, size) && serializer.feed(data, size);
+				} while (isFed && size > 0u);
+			}
+			bool isRead = serializer.endIncrementalRead() && isFed;
 
-		return true;
+			fclose(fp);
+			return isRead;
+		}));
 	}
 }
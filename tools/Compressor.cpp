@@ -0,0 +1,342 @@
+#include "Compressor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+
+namespace mirror
+{
+	static const size_t LZMinMatchSize = 4u;
+	static const size_t LZMaxOffset = 0xFFFFu;
+	static const unsigned LZHashBits = 14u;
+
+	static uint32_t ReadUInt32(const uint8_t* _data)
+	{
+		uint32_t value;
+		memcpy(&value, _data, sizeof(value));
+		return value;
+	}
+
+	static uint32_t HashUInt32(uint32_t _value)
+	{
+		return (_value * 2654435761u) >> (32u - LZHashBits);
+	}
+
+	// Lengths of 15 and more go on in the next bytes, each adding up to 255
+	static uint8_t* WriteLZLength(uint8_t* _out, size_t _length)
+	{
+		for (; _length >= 255u; _length -= 255u)
+		{
+			*_out++ = 255u;
+		}
+		*_out++ = static_cast<uint8_t>(_length);
+		return _out;
+	}
+
+	static bool ReadLZLength(const uint8_t* _data, size_t _dataSize, size_t& _cursor, size_t& _length)
+	{
+		uint8_t byte = 255u;
+		while (byte == 255u)
+		{
+			if (_cursor >= _dataSize)
+				return false;
+			byte = _data[_cursor++];
+			_length += byte;
+		}
+		return true;
+	}
+
+	size_t LZCompressor::getMaxCompressedSize(size_t _size) const
+	{
+		return _size + _size / 255u + 16u;
+	}
+
+	size_t LZCompressor::getMaxDecompressedSize(size_t _compressedSize) const
+	{
+		// Each byte of a match length adds 255 bytes at most, and sequences without them are longer than 1/255th of their output
+		return _compressedSize > SIZE_MAX / 255u ? SIZE_MAX : _compressedSize * 255u;
+	}
+
+	// Sequences are [token: literal count << 4 | match size - 4][literal count rest][literals][u16 offset][match size rest], the last one without match
+	static uint8_t* WriteLZSequence(uint8_t* _out, const uint8_t* _literals, size_t _literalCount, size_t _offset, size_t _matchSize)
+	{
+		uint8_t* token = _out++;
+		*token = static_cast<uint8_t>(std::min<size_t>(_literalCount, 15u) << 4);
+		if (_literalCount >= 15u)
+			_out = WriteLZLength(_out, _literalCount - 15u);
+		memcpy(_out, _literals, _literalCount);
+		_out += _literalCount;
+
+		if (_matchSize == 0u)
+			return _out;
+
+		_out[0] = static_cast<uint8_t>(_offset);
+		_out[1] = static_cast<uint8_t>(_offset >> 8);
+		_out += 2;
+		size_t matchLength = _matchSize - LZMinMatchSize;
+		*token |= static_cast<uint8_t>(std::min<size_t>(matchLength, 15u));
+		if (matchLength >= 15u)
+			_out = WriteLZLength(_out, matchLength - 15u);
+		return _out;
+	}
+
+	size_t LZCompressor::compress(const uint8_t* _data, size_t _size, uint8_t* _outData, size_t _capacity) const
+	{
+		uint32_t table[1u << LZHashBits];
+		memset(table, 0, sizeof(table));
+
+		uint8_t* out = _outData;
+		uint8_t* outEnd = _outData + _capacity;
+		size_t anchor = 0u;
+		size_t position = 0u;
+		while (position + LZMinMatchSize <= _size)
+		{
+			uint32_t value = ReadUInt32(_data + position);
+			uint32_t hash = HashUInt32(value);
+			size_t candidate = table[hash];
+			table[hash] = static_cast<uint32_t>(position);
+
+			if (candidate >= position || position - candidate > LZMaxOffset || ReadUInt32(_data + candidate) != value)
+			{
+				// Skips faster through data that does not match
+				position += 1u + ((position - anchor) >> 6);
+				continue;
+			}
+
+			size_t matchSize = LZMinMatchSize;
+			while (position + matchSize < _size && _data[candidate + matchSize] == _data[position + matchSize])
+			{
+				++matchSize;
+			}
+
+			size_t literalCount = position - anchor;
+			if (static_cast<size_t>(outEnd - out) < literalCount + literalCount / 255u + matchSize / 255u + 8u)
+				return 0u;
+			out = WriteLZSequence(out, _data + anchor, literalCount, position - candidate, matchSize);
+
+			position += matchSize;
+			anchor = position;
+			if (position + LZMinMatchSize <= _size)
+				table[HashUInt32(ReadUInt32(_data + position - 2u))] = static_cast<uint32_t>(position - 2u);
+		}
+
+		size_t literalCount = _size - anchor;
+		if (literalCount > 0u)
+		{
+			if (static_cast<size_t>(outEnd - out) < literalCount + literalCount / 255u + 2u)
+				return 0u;
+			out = WriteLZSequence(out, _data + anchor, literalCount, 0u, 0u);
+		}
+		return static_cast<size_t>(out - _outData);
+	}
+
+	bool LZCompressor::decompress(const uint8_t* _data, size_t _dataSize, uint8_t* _outData, size_t _size) const
+	{
+		size_t cursor = 0u;
+		size_t outCursor = 0u;
+		while (cursor < _dataSize)
+		{
+			uint8_t token = _data[cursor++];
+			size_t literalCount = token >> 4;
+			if (literalCount == 15u && !ReadLZLength(_data, _dataSize, cursor, literalCount))
+				return false;
+			if (literalCount > _dataSize - cursor || literalCount > _size - outCursor)
+				return false;
+			memcpy(_outData + outCursor, _data + cursor, literalCount);
+			cursor += literalCount;
+			outCursor += literalCount;
+
+			// The last sequence has no match
+			if (cursor == _dataSize)
+				break;
+
+			if (_dataSize - cursor < 2u)
+				return false;
+			size_t offset = static_cast<size_t>(_data[cursor]) | static_cast<size_t>(_data[cursor + 1u]) << 8;
+			cursor += 2u;
+			size_t matchSize = token & 0x0Fu;
+			if (matchSize == 15u && !ReadLZLength(_data, _dataSize, cursor, matchSize))
+				return false;
+			matchSize += LZMinMatchSize;
+			if (offset == 0u || offset > outCursor || matchSize > _size - outCursor)
+				return false;
+
+			uint8_t* match = _outData + outCursor - offset;
+			uint8_t* out = _outData + outCursor;
+			if (offset >= matchSize)
+			{
+				memcpy(out, match, matchSize);
+			}
+			else
+			{
+				// Overlapping, repeats the last offset bytes
+				for (size_t i = 0; i < matchSize; ++i)
+				{
+					out[i] = match[i];
+				}
+			}
+			outCursor += matchSize;
+		}
+		return outCursor == _size;
+	}
+
+	static std::atomic<Compressor*> s_compressors[256];
+
+	void RegisterCompressor(Compressor* _compressor)
+	{
+		assert(_compressor);
+		assert(_compressor->getId() != LZCompressor::Id);
+		s_compressors[_compressor->getId()].store(_compressor, std::memory_order_release);
+	}
+
+	Compressor* FindCompressor(uint8_t _id)
+	{
+		if (_id == LZCompressor::Id)
+			return GetLZCompressor();
+		return s_compressors[_id].load(std::memory_order_acquire);
+	}
+
+	LZCompressor* GetLZCompressor()
+	{
+		static LZCompressor s_compressor;
+		return &s_compressor;
+	}
+
+	static size_t WriteBlockVarint(uint8_t* _bytes, uint64_t _value)
+	{
+		size_t size = 0u;
+		while (_value >= 0x80u)
+		{
+			_bytes[size++] = static_cast<uint8_t>(_value) | 0x80u;
+			_value >>= 7;
+		}
+		_bytes[size++] = static_cast<uint8_t>(_value);
+		return size;
+	}
+
+	static bool ReadBlockVarint(const uint8_t* _bytes, size_t _size, size_t& _cursor, uint64_t& _outValue)
+	{
+		uint64_t value = 0u;
+		for (unsigned shift = 0u; shift < 64u && _cursor < _size; shift += 7u)
+		{
+			uint8_t byte = _bytes[_cursor++];
+			value |= static_cast<uint64_t>(byte & 0x7Fu) << shift;
+			if ((byte & 0x80u) == 0u)
+			{
+				_outValue = value;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void AppendCompressedBlock(const Compressor* _compressor, const uint8_t* _data, size_t _size, std::vector<uint8_t>& _outBlocks)
+	{
+		size_t blockPosition = _outBlocks.size();
+		size_t maxHeaderSize = 20u;
+		_outBlocks.resize(blockPosition + maxHeaderSize + std::max(_compressor->getMaxCompressedSize(_size), _size));
+
+		// Compressed after room for the header, moved back once its size is known
+		uint8_t* stored = _outBlocks.data() + blockPosition + maxHeaderSize;
+		size_t storedSize = _compressor->compress(_data, _size, stored, _size);
+		if (storedSize == 0u || storedSize >= _size)
+		{
+			storedSize = _size;
+			memcpy(stored, _data, _size);
+		}
+
+		uint8_t header[20];
+		size_t headerSize = WriteBlockVarint(header, _size);
+		headerSize += WriteBlockVarint(header + headerSize, storedSize);
+		memcpy(_outBlocks.data() + blockPosition, header, headerSize);
+		memmove(_outBlocks.data() + blockPosition + headerSize, stored, storedSize);
+		_outBlocks.resize(blockPosition + headerSize + storedSize);
+	}
+
+	bool ReadCompressedBlockHeader(const Compressor* _compressor, const uint8_t* _data, size_t _dataSize, size_t& _outHeaderSize, size_t& _outSize, size_t& _outStoredSize)
+	{
+		size_t cursor = 0u;
+		uint64_t size = 0u;
+		uint64_t storedSize = 0u;
+		if (!ReadBlockVarint(_data, _dataSize, cursor, size) || !ReadBlockVarint(_data, _dataSize, cursor, storedSize) || storedSize > size || size > SIZE_MAX)
+			return false;
+		// Blocks stored as is have the same size
+		if (storedSize < size && size > _compressor->getMaxDecompressedSize(static_cast<size_t>(storedSize)))
+			return false;
+
+		_outHeaderSize = cursor;
+		_outSize = static_cast<size_t>(size);
+		_outStoredSize = static_cast<size_t>(storedSize);
+		return true;
+	}
+
+	bool DecompressBlock(const Compressor* _compressor, const uint8_t* _storedData, size_t _storedSize, uint8_t* _outData, size_t _size)
+	{
+		if (_storedSize == _size)
+		{
+			memcpy(_outData, _storedData, _size);
+			return true;
+		}
+		return _compressor->decompress(_storedData, _storedSize, _outData, _size);
+	}
+
+	CompressingSink::CompressingSink(OutputSink* _sink, const Compressor* _compressor, size_t _blockSize)
+		: m_sink(_sink)
+		, m_compressor(_compressor)
+		, m_blockSize(_blockSize)
+	{
+		assert(m_sink);
+		assert(m_compressor);
+		assert(m_blockSize > 0u);
+		m_block.reserve(m_blockSize);
+	}
+
+	bool CompressingSink::write(const OutputSegment* _segments, size_t _segmentCount)
+	{
+		for (size_t i = 0; i < _segmentCount; ++i)
+		{
+			const uint8_t* data = reinterpret_cast<const uint8_t*>(_segments[i].data);
+			size_t size = _segments[i].size;
+			while (size > 0u)
+			{
+				// Whole blocks are compressed from the segment without copy
+				if (m_block.empty() && size >= m_blockSize)
+				{
+					if (!_writeBlock(data, m_blockSize))
+						return false;
+					data += m_blockSize;
+					size -= m_blockSize;
+					continue;
+				}
+
+				size_t copiedSize = std::min(size, m_blockSize - m_block.size());
+				m_block.insert(m_block.end(), data, data + copiedSize);
+				data += copiedSize;
+				size -= copiedSize;
+				if (m_block.size() == m_blockSize)
+				{
+					if (!_writeBlock(m_block.data(), m_block.size()))
+						return false;
+					m_block.clear();
+				}
+			}
+		}
+		return true;
+	}
+
+	bool CompressingSink::finish()
+	{
+		bool isWritten = m_block.empty() || _writeBlock(m_block.data(), m_block.size());
+		m_block.clear();
+		return isWritten;
+	}
+
+	bool CompressingSink::_writeBlock(const uint8_t* _data, size_t _size)
+	{
+		m_compressedBlock.clear();
+		AppendCompressedBlock(m_compressor, _data, _size, m_compressedBlock);
+		OutputSegment segment = { m_compressedBlock.data(), m_compressedBlock.size() };
+		return m_sink->write(&segment, 1u);
+	}
+}
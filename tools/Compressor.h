@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "OutputSink.h"
+
+namespace mirror
+{
+	// Codec of independent blocks. Ids are written in the files, 1 is LZCompressor, ids from 128 are free for other codecs.
+	class Compressor
+	{
+	public:
+		virtual ~Compressor() {}
+
+		virtual uint8_t getId() const = 0;
+		virtual size_t getMaxCompressedSize(size_t _size) const = 0;
+		// Bound of the size _compressedSize bytes may decompress to, against which the sizes read from the files are checked
+		virtual size_t getMaxDecompressedSize(size_t _compressedSize) const = 0;
+		// Returns the compressed size, 0 when it does not fit in _capacity
+		virtual size_t compress(const uint8_t* _data, size_t _size, uint8_t* _outData, size_t _capacity) const = 0;
+		// Returns false when the data is invalid or does not decompress to exactly _size bytes
+		virtual bool decompress(const uint8_t* _data, size_t _dataSize, uint8_t* _outData, size_t _size) const = 0;
+	};
+
+	// Fast LZ77 codec: sequences of literals and matches of at least 4 bytes within the last 64KB, found through a hash of 4 bytes
+	class LZCompressor : public Compressor
+	{
+	public:
+		static constexpr uint8_t Id = 1u;
+
+		virtual uint8_t getId() const override { return Id; }
+		virtual size_t getMaxCompressedSize(size_t _size) const override;
+		virtual size_t getMaxDecompressedSize(size_t _compressedSize) const override;
+		virtual size_t compress(const uint8_t* _data, size_t _size, uint8_t* _outData, size_t _capacity) const override;
+		virtual bool decompress(const uint8_t* _data, size_t _dataSize, uint8_t* _outData, size_t _size) const override;
+	};
+
+	// Compressors found by the id written in the files. LZCompressor is registered from the start.
+	void RegisterCompressor(Compressor* _compressor);
+	Compressor* FindCompressor(uint8_t _id);
+	LZCompressor* GetLZCompressor();
+
+	// Blocks are [varint size][varint stored size][stored bytes], stored as is when compressing does not make them smaller
+	void AppendCompressedBlock(const Compressor* _compressor, const uint8_t* _data, size_t _size, std::vector<uint8_t>& _outBlocks);
+	// Returns false when the header is incomplete or invalid, including sizes that the stored bytes cannot decompress to with _compressor
+	bool ReadCompressedBlockHeader(const Compressor* _compressor, const uint8_t* _data, size_t _dataSize, size_t& _outHeaderSize, size_t& _outSize, size_t& _outStoredSize);
+	bool DecompressBlock(const Compressor* _compressor, const uint8_t* _storedData, size_t _storedSize, uint8_t* _outData, size_t _size);
+
+	// Compresses what is written to it by blocks of _blockSize bytes, written to _sink as they are complete
+	class CompressingSink : public OutputSink
+	{
+	public:
+		CompressingSink(OutputSink* _sink, const Compressor* _compressor, size_t _blockSize);
+
+		virtual bool write(const OutputSegment* _segments, size_t _segmentCount) override;
+		// Writes the last block
+		bool finish();
+
+	private:
+		bool _writeBlock(const uint8_t* _data, size_t _size);
+
+		OutputSink* m_sink;
+		const Compressor* m_compressor;
+		size_t m_blockSize;
+		std::vector<uint8_t> m_block;
+		std::vector<uint8_t> m_compressedBlock;
+	};
+}
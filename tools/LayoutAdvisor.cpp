@@ -0,0 +1,197 @@
+#include "LayoutAdvisor.h"
+
+#include <algorithm>
+#include <cassert>
+#include "../mirror.h"
+
+namespace mirror
+{
+	static size_t AlignUp(size_t _value, size_t _alignment)
+	{
+		return _alignment > 1u ? (_value + _alignment - 1u) / _alignment * _alignment : _value;
+	}
+
+	LayoutAdvisor::LayoutAdvisor(const char* _cacheLineMetaDataKey, size_t _cacheLineSize)
+		: m_cacheLineMetaDataKey(_cacheLineMetaDataKey)
+		, m_cacheLineSize(_cacheLineSize)
+	{
+		assert(m_cacheLineSize > 0u);
+	}
+
+	void LayoutAdvisor::analyzeClass(const Class* _class, ClassReport& _outReport) const
+	{
+		assert(_class);
+
+		_outReport = ClassReport();
+		_outReport.clss = _class;
+		_outReport.size = _class->getSize();
+		_outReport.alignment = std::max<size_t>(_class->getAlignment(), 1u);
+
+		std::vector<ClassMember*> members;
+		_class->getMembers(members, false);
+		if (members.empty())
+		{
+			_outReport.headerSize = _outReport.size;
+			_outReport.suggestedSize = _outReport.size;
+			return;
+		}
+
+		std::sort(members.begin(), members.end(), [](const ClassMember* _a, const ClassMember* _b) { return _a->getOffset() < _b->getOffset(); });
+
+		_outReport.members.resize(members.size());
+		for (size_t i = 0; i < members.size(); ++i)
+		{
+			MemberLayout& layout = _outReport.members[i];
+			layout.member = members[i];
+			layout.offset = members[i]->getOffset();
+
+			const TypeDesc* type = members[i]->getType();
+			if (type && type->getSize() > 0u)
+			{
+				layout.size = type->getSize();
+				layout.alignment = std::max<size_t>(type->getAlignment(), 1u);
+			}
+			else
+			{
+				// Unknown type: assume it fills the space up to the next member so that no padding is reported for it
+				size_t end = i + 1 < members.size() ? members[i + 1]->getOffset() : _outReport.size;
+				layout.size = end - layout.offset;
+				layout.alignment = 1u;
+			}
+		}
+
+		_outReport.headerSize = _outReport.members.front().offset;
+		size_t cursor = _outReport.headerSize;
+		for (MemberLayout& layout : _outReport.members)
+		{
+			layout.paddingBefore = layout.offset > cursor ? layout.offset - cursor : 0u;
+			_outReport.paddingBytes += layout.paddingBefore;
+			cursor = std::max(cursor, layout.offset + layout.size);
+		}
+		_outReport.tailPadding = _outReport.size > cursor ? _outReport.size - cursor : 0u;
+
+		// Suggested order: placing the most aligned members first leaves no hole between them
+		std::vector<const MemberLayout*> sortedLayouts;
+		for (const MemberLayout& layout : _outReport.members)
+		{
+			sortedLayouts.push_back(&layout);
+		}
+		std::stable_sort(sortedLayouts.begin(), sortedLayouts.end(), [](const MemberLayout* _a, const MemberLayout* _b)
+		{
+			if (_a->alignment != _b->alignment)
+				return _a->alignment > _b->alignment;
+			return _a->size > _b->size;
+		});
+
+		cursor = _outReport.headerSize;
+		for (const MemberLayout* layout : sortedLayouts)
+		{
+			_outReport.suggestedOrder.push_back(layout->member);
+			cursor = AlignUp(cursor, layout->alignment) + layout->size;
+		}
+		_outReport.suggestedSize = std::min(AlignUp(cursor, _outReport.alignment), _outReport.size);
+
+		// Tagged members sharing a cache line
+		if (m_cacheLineMetaDataKey)
+		{
+			std::vector<const MemberLayout*> taggedLayouts;
+			for (const MemberLayout& layout : _outReport.members)
+			{
+				if (layout.member->GetMetaDataSet().findMetaData(m_cacheLineMetaDataKey))
+					taggedLayouts.push_back(&layout);
+			}
+
+			for (size_t i = 0; i < taggedLayouts.size(); ++i)
+			{
+				const MemberLayout* a = taggedLayouts[i];
+				size_t aFirstLine = a->offset / m_cacheLineSize;
+				size_t aLastLine = (a->offset + std::max<size_t>(a->size, 1u) - 1u) / m_cacheLineSize;
+				for (size_t j = i + 1; j < taggedLayouts.size(); ++j)
+				{
+					const MemberLayout* b = taggedLayouts[j];
+					size_t bFirstLine = b->offset / m_cacheLineSize;
+					size_t bLastLine = (b->offset + std::max<size_t>(b->size, 1u) - 1u) / m_cacheLineSize;
+					if (bFirstLine <= aLastLine && aFirstLine <= bLastLine)
+					{
+						CacheLineWarning warning;
+						warning.first = a->member;
+						warning.second = b->member;
+						warning.cacheLine = std::max(aFirstLine, bFirstLine);
+						_outReport.cacheLineWarnings.push_back(warning);
+					}
+				}
+			}
+		}
+	}
+
+	void LayoutAdvisor::analyzeTypeSet(const TypeSet* _typeSet, Report& _outReport) const
+	{
+		assert(_typeSet);
+
+		_outReport = Report();
+		for (TypeDesc* type : _typeSet->getTypes())
+		{
+			if (type->getType() != Type_Class)
+				continue;
+
+			_outReport.classes.emplace_back();
+			ClassReport& classReport = _outReport.classes.back();
+			analyzeClass(static_cast<const Class*>(type), classReport);
+
+			_outReport.totalSize += classReport.size;
+			_outReport.totalWastedBytes += classReport.getWastedBytes();
+			_outReport.totalSuggestedSize += classReport.suggestedSize;
+		}
+
+		std::stable_sort(_outReport.classes.begin(), _outReport.classes.end(), [](const ClassReport& _a, const ClassReport& _b)
+		{
+			return _a.getWastedBytes() > _b.getWastedBytes();
+		});
+	}
+
+	void LayoutAdvisor::PrintReport(const Report& _report, FILE* _file)
+	{
+		assert(_file);
+
+		fprintf(_file, "%zu classes, %zu bytes, %zu wasted (%.2f%%), %zu bytes with suggested member orders\n",
+			_report.classes.size(), _report.totalSize, _report.totalWastedBytes, _report.getWastedPercentage(), _report.totalSuggestedSize);
+
+		for (const ClassReport& classReport : _report.classes)
+		{
+			PrintClassReport(classReport, _file);
+		}
+	}
+
+	void LayoutAdvisor::PrintClassReport(const ClassReport& _report, FILE* _file)
+	{
+		assert(_file);
+		assert(_report.clss);
+
+		fprintf(_file, "\n%s: size %zu, align %zu, header %zu, padding %zu, tail padding %zu\n",
+			_report.clss->getName(), _report.size, _report.alignment, _report.headerSize, _report.paddingBytes, _report.tailPadding);
+
+		for (const MemberLayout& layout : _report.members)
+		{
+			if (layout.paddingBefore > 0u)
+				fprintf(_file, "\t[%zu bytes of padding]\n", layout.paddingBefore);
+			fprintf(_file, "\t%4zu %-32s size %zu, align %zu\n", layout.offset, layout.member->getName(), layout.size, layout.alignment);
+		}
+		if (_report.tailPadding > 0u)
+			fprintf(_file, "\t[%zu bytes of tail padding]\n", _report.tailPadding);
+
+		if (_report.suggestedSize < _report.size)
+		{
+			fprintf(_file, "\tsuggested order (%zu bytes, saves %zu):", _report.suggestedSize, _report.size - _report.suggestedSize);
+			for (const ClassMember* member : _report.suggestedOrder)
+			{
+				fprintf(_file, " %s", member->getName());
+			}
+			fprintf(_file, "\n");
+		}
+
+		for (const CacheLineWarning& warning : _report.cacheLineWarnings)
+		{
+			fprintf(_file, "\twarning: %s and %s share cache line %zu\n", warning.first->getName(), warning.second->getName(), warning.cacheLine);
+		}
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace mirror
+{
+	class Class;
+	class ClassMember;
+	class TypeSet;
+
+	// Reports the padding carried by reflected classes, using the member offsets and type sizes known by the registry.
+	// Only the reflected members of a class are considered:
+	// - bytes before its first member (vtable pointer, parent classes) are reported as header, not as padding.
+	// - unreflected members living between two reflected ones are counted as padding.
+	class LayoutAdvisor
+	{
+	public:
+		struct MemberLayout
+		{
+			const ClassMember* member = nullptr;
+			size_t offset = 0u;
+			size_t size = 0u;
+			size_t alignment = 0u;
+			size_t paddingBefore = 0u;
+		};
+
+		struct CacheLineWarning
+		{
+			const ClassMember* first = nullptr;
+			const ClassMember* second = nullptr;
+			size_t cacheLine = 0u;
+		};
+
+		struct ClassReport
+		{
+			const Class* clss = nullptr;
+			size_t size = 0u;
+			size_t alignment = 0u;
+			size_t headerSize = 0u;
+			size_t paddingBytes = 0u; // Holes between members, tail padding excluded
+			size_t tailPadding = 0u;
+
+			std::vector<MemberLayout> members; // Sorted by offset
+
+			std::vector<const ClassMember*> suggestedOrder; // Decreasing alignment, then decreasing size
+			size_t suggestedSize = 0u;
+
+			std::vector<CacheLineWarning> cacheLineWarnings;
+
+			size_t getWastedBytes() const { return paddingBytes + tailPadding; }
+		};
+
+		struct Report
+		{
+			std::vector<ClassReport> classes; // Sorted by decreasing wasted bytes
+			size_t totalSize = 0u;
+			size_t totalWastedBytes = 0u;
+			size_t totalSuggestedSize = 0u;
+
+			float getWastedPercentage() const { return totalSize ? 100.f * float(totalWastedBytes) / float(totalSize) : 0.f; }
+		};
+
+		// Members tagged with _cacheLineMetaDataKey are expected to live alone on their cache line (e.g. atomics written by different threads).
+		// Cache lines are computed assuming instances are aligned on _cacheLineSize.
+		LayoutAdvisor(const char* _cacheLineMetaDataKey = "Atomic", size_t _cacheLineSize = 64u);
+
+		void analyzeClass(const Class* _class, ClassReport& _outReport) const;
+		void analyzeTypeSet(const TypeSet* _typeSet, Report& _outReport) const;
+
+		static void PrintReport(const Report& _report, FILE* _file = stdout);
+		static void PrintClassReport(const ClassReport& _report, FILE* _file = stdout);
+
+	private:
+		const char* m_cacheLineMetaDataKey;
+		size_t m_cacheLineSize;
+	};
+}
@@ -0,0 +1,116 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mirror
+{
+	static const char s_emptyFileData[1] = { 0 };
+
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	bool MappedFile::open(const char* _fileName)
+	{
+		close();
+
+#ifdef _WIN32
+		HANDLE fileHandle = CreateFileA(_fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fileHandle, &fileSize))
+		{
+			CloseHandle(fileHandle);
+			return false;
+		}
+
+		m_size = static_cast<size_t>(fileSize.QuadPart);
+		if (m_size == 0u)
+		{
+			CloseHandle(fileHandle);
+			m_data = s_emptyFileData;
+			return true;
+		}
+
+		HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		const void* data = mappingHandle ? MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (!data)
+		{
+			if (mappingHandle)
+				CloseHandle(mappingHandle);
+			CloseHandle(fileHandle);
+			m_size = 0u;
+			return false;
+		}
+
+		m_fileHandle = fileHandle;
+		m_mappingHandle = mappingHandle;
+#else
+		int fd = ::open(_fileName, O_RDONLY);
+		if (fd < 0)
+			return false;
+
+		struct stat fileStat;
+		if (fstat(fd, &fileStat) != 0)
+		{
+			::close(fd);
+			return false;
+		}
+
+		m_size = static_cast<size_t>(fileStat.st_size);
+		if (m_size == 0u)
+		{
+			::close(fd);
+			m_data = s_emptyFileData;
+			return true;
+		}
+
+		// The mapping stays valid once the descriptor is closed
+		void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (data == MAP_FAILED)
+		{
+			m_size = 0u;
+			return false;
+		}
+
+		// Decoding reads the file front to back
+		madvise(data, m_size, MADV_SEQUENTIAL);
+#endif
+
+		m_data = data;
+		m_isMapped = true;
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (m_isMapped)
+		{
+#ifdef _WIN32
+			UnmapViewOfFile(m_data);
+			CloseHandle(m_mappingHandle);
+			CloseHandle(m_fileHandle);
+			m_fileHandle = nullptr;
+			m_mappingHandle = nullptr;
+#else
+			munmap(const_cast<void*>(m_data), m_size);
+#endif
+		}
+
+		m_data = nullptr;
+		m_size = 0u;
+		m_isMapped = false;
+	}
+}
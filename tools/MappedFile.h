@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+namespace mirror
+{
+	// Read-only memory mapping of a whole file. Data decoded from the mapping, such as string views, is valid until it is closed.
+	class MappedFile
+	{
+	public:
+		MappedFile() {}
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool open(const char* _fileName);
+		void close();
+
+		bool isOpen() const { return m_data != nullptr; }
+		const void* getData() const { return m_data; }
+		size_t getSize() const { return m_size; }
+
+	private:
+		const void* m_data = nullptr;
+		size_t m_size = 0u;
+
+#ifdef _WIN32
+		void* m_fileHandle = nullptr;
+		void* m_mappingHandle = nullptr;
+#endif
+		// Empty files can not be mapped, they are opened as a buffer of zero byte
+		bool m_isMapped = false;
+	};
+}
@@ -0,0 +1,90 @@
+#include "OutputSink.h"
+
+#include <algorithm>
+#include <cerrno>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <climits>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace mirror
+{
+	bool FileDescriptorSink::write(const OutputSegment* _segments, size_t _segmentCount)
+	{
+#ifdef _WIN32
+		for (size_t i = 0; i < _segmentCount; ++i)
+		{
+			const char* data = reinterpret_cast<const char*>(_segments[i].data);
+			size_t remainingSize = _segments[i].size;
+			while (remainingSize > 0u)
+			{
+				int writtenSize = _write(m_fileDescriptor, data, static_cast<unsigned int>(std::min<size_t>(remainingSize, INT_MAX)));
+				if (writtenSize <= 0)
+					return false;
+				data += writtenSize;
+				remainingSize -= static_cast<size_t>(writtenSize);
+			}
+		}
+		return true;
+#else
+		const size_t maxSegmentCount = 64u;
+		struct iovec vectors[maxSegmentCount];
+		size_t segmentIndex = 0u;
+		size_t segmentOffset = 0u;
+		while (segmentIndex < _segmentCount)
+		{
+			// Partial writes resume from the first byte that was not written
+			int vectorCount = 0;
+			for (size_t i = segmentIndex; i < _segmentCount && vectorCount < static_cast<int>(maxSegmentCount); ++i)
+			{
+				size_t offset = i == segmentIndex ? segmentOffset : 0u;
+				vectors[vectorCount].iov_base = const_cast<char*>(reinterpret_cast<const char*>(_segments[i].data)) + offset;
+				vectors[vectorCount].iov_len = _segments[i].size - offset;
+				++vectorCount;
+			}
+
+			ssize_t writtenSize = writev(m_fileDescriptor, vectors, vectorCount);
+			if (writtenSize < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				return false;
+			}
+
+			size_t remainingSize = static_cast<size_t>(writtenSize);
+			while (segmentIndex < _segmentCount && remainingSize >= _segments[segmentIndex].size - segmentOffset)
+			{
+				remainingSize -= _segments[segmentIndex].size - segmentOffset;
+				segmentOffset = 0u;
+				++segmentIndex;
+			}
+			segmentOffset += remainingSize;
+		}
+		return true;
+#endif
+	}
+
+	bool FileSink::write(const OutputSegment* _segments, size_t _segmentCount)
+	{
+		for (size_t i = 0; i < _segmentCount; ++i)
+		{
+			if (_segments[i].size > 0u && fwrite(_segments[i].data, _segments[i].size, 1, m_file) != 1)
+				return false;
+		}
+		return true;
+	}
+
+	bool CallbackSink::write(const OutputSegment* _segments, size_t _segmentCount)
+	{
+		for (size_t i = 0; i < _segmentCount; ++i)
+		{
+			if (_segments[i].size > 0u && !m_callback(_segments[i].data, _segments[i].size))
+				return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+
+namespace mirror
+{
+	struct OutputSegment
+	{
+		const void* data;
+		size_t size;
+	};
+
+	// Destination of a streamed output. Segments are written in order, and are only valid during the call.
+	class OutputSink
+	{
+	public:
+		virtual ~OutputSink() {}
+
+		// Returns false when the segments could not be written entirely
+		virtual bool write(const OutputSegment* _segments, size_t _segmentCount) = 0;
+		// Whether the next writes will fail anyway, polled while the output is measured before being written. Must be cheap.
+		virtual bool hasFailed() const { return false; }
+	};
+
+	// Writes to a file descriptor, several segments at once with writev where available
+	class FileDescriptorSink : public OutputSink
+	{
+	public:
+		FileDescriptorSink(int _fileDescriptor) : m_fileDescriptor(_fileDescriptor) {}
+
+		virtual bool write(const OutputSegment* _segments, size_t _segmentCount) override;
+
+	private:
+		int m_fileDescriptor;
+	};
+
+	class FileSink : public OutputSink
+	{
+	public:
+		FileSink(FILE* _file) : m_file(_file) {}
+
+		virtual bool write(const OutputSegment* _segments, size_t _segmentCount) override;
+
+	private:
+		FILE* m_file;
+	};
+
+	class CallbackSink : public OutputSink
+	{
+	public:
+		using Callback = std::function<bool(const void* _data, size_t _size)>;
+
+		CallbackSink(Callback _callback) : m_callback(std::move(_callback)) {}
+
+		virtual bool write(const OutputSegment* _segments, size_t _segmentCount) override;
+
+	private:
+		Callback m_callback;
+	};
+}
@@ -0,0 +1,89 @@
+#include "ThreadPool.h"
+
+namespace mirror
+{
+	ThreadPool::ThreadPool(size_t _threadCount)
+	{
+		for (size_t i = 1; i < _threadCount; ++i)
+		{
+			m_threads.emplace_back(&ThreadPool::_run, this, i);
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_isStopping = true;
+		}
+		m_startCondition.notify_all();
+
+		for (std::thread& thread : m_threads)
+		{
+			thread.join();
+		}
+	}
+
+	void ThreadPool::parallelFor(size_t _count, const std::function<void(size_t _index, size_t _threadIndex)>& _function)
+	{
+		if (_count == 0u)
+			return;
+
+		if (m_threads.empty() || _count == 1u)
+		{
+			for (size_t i = 0; i < _count; ++i)
+			{
+				_function(i, 0u);
+			}
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_function = &_function;
+			m_count = _count;
+			m_nextIndex = 0u;
+			m_busyThreadCount = m_threads.size();
+			++m_generation;
+		}
+		m_startCondition.notify_all();
+
+		_work(0u);
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_endCondition.wait(lock, [this]() { return m_busyThreadCount == 0u; });
+		m_function = nullptr;
+	}
+
+	void ThreadPool::_run(size_t _threadIndex)
+	{
+		size_t generation = 0u;
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_startCondition.wait(lock, [this, generation]() { return m_isStopping || m_generation != generation; });
+				if (m_isStopping)
+					return;
+				generation = m_generation;
+			}
+
+			_work(_threadIndex);
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				--m_busyThreadCount;
+			}
+			m_endCondition.notify_one();
+		}
+	}
+
+	void ThreadPool::_work(size_t _threadIndex)
+	{
+		// Iterations are taken one at a time, so that uneven ones balance across threads
+		for (size_t index = m_nextIndex.fetch_add(1u); index < m_count; index = m_nextIndex.fetch_add(1u))
+		{
+			(*m_function)(index, _threadIndex);
+		}
+	}
+}
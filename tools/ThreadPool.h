@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mirror
+{
+	// Threads running the iterations of parallel loops, along with the calling thread
+	class ThreadPool
+	{
+	public:
+		// Starts _threadCount - 1 threads
+		ThreadPool(size_t _threadCount);
+		~ThreadPool();
+
+		size_t getThreadCount() const { return m_threads.size() + 1u; }
+
+		// Calls _function(index, threadIndex) for each index in [0, _count), and returns once all calls are done.
+		// threadIndex is in [0, getThreadCount()), 0 being the calling thread. Not reentrant.
+		void parallelFor(size_t _count, const std::function<void(size_t _index, size_t _threadIndex)>& _function);
+
+	private:
+		void _run(size_t _threadIndex);
+		void _work(size_t _threadIndex);
+
+		std::vector<std::thread> m_threads;
+		std::mutex m_mutex;
+		std::condition_variable m_startCondition;
+		std::condition_variable m_endCondition;
+
+		const std::function<void(size_t, size_t)>* m_function = nullptr;
+		size_t m_count = 0u;
+		std::atomic<size_t> m_nextIndex = { 0u };
+		size_t m_generation = 0u;
+		size_t m_busyThreadCount = 0u;
+		bool m_isStopping = false;
+	};
+}